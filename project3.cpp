@@ -6,10 +6,29 @@
 #include <vector>
 #include <cstdlib>
 #include <ctime>
+#include <thread>
+#include <atomic>
+#include <random>
+#include <memory>
+#include <chrono>
+#include <algorithm>
+#include <cstdint>
+#include <cmath>
+#include <cstring>
+#include <array>
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 using namespace std;
 
 // Enum for the possible states of a tile
-enum class TileState {
+enum class TileState : unsigned char {
     Hidden,
     Revealed,
     Number,
@@ -17,122 +36,118 @@ enum class TileState {
     Mine
 };
 
-// Class representing a tile on the Minesweeper board
-class Tile {
-public:
-    Tile();
-    void setState(TileState newState, int newNumber = 0);
-    TileState getState() const;
-    void draw(sf::RenderWindow& window, int x, int y);
+// Textures for the tiles, loaded once and shared by everything that draws tiles
+struct TileTextures {
+    sf::Texture hidden;
+    sf::Texture revealed;
+    sf::Texture numbers[8]; // 1-8
+    sf::Texture flag;
+    sf::Texture mine;
 
-private:
-    TileState state;
-    TileState originalState; // storing the original state for flags
-    int number;
-    sf::Texture hiddenTexture;
-    sf::Texture revealedTexture;
-    vector<sf::Texture> numberTextures;
-    sf::Texture flagTexture;
-    sf::Texture mineTexture;
-    sf::Sprite sprite;
+    void load();
 };
 
-Tile::Tile() : state(TileState::Hidden), number(0) {
-    hiddenTexture.loadFromFile("images/tile_hidden.png");
-    revealedTexture.loadFromFile("images/tile_revealed.png");
-    flagTexture.loadFromFile("images/flag.png");  
-    mineTexture.loadFromFile("images/mine.png");
+void TileTextures::load() {
+    hidden.loadFromFile("images/tile_hidden.png");
+    revealed.loadFromFile("images/tile_revealed.png");
+    flag.loadFromFile("images/flag.png");
+    mine.loadFromFile("images/mine.png");
 
     // Load number textures (1-8)
-    numberTextures.resize(8);
     for (int i = 0; i < 8; ++i) {
-        numberTextures[i].loadFromFile("images/number_" + to_string(i + 1) + ".png");
+        numbers[i].loadFromFile("images/number_" + to_string(i + 1) + ".png");
     }
-
-    sprite.setTexture(hiddenTexture);
 }
 
-void Tile::setState(TileState newState, int newNumber) {
-    state = newState;
-    number = newNumber;
+// Function to draw one tile: the background, then the number, flag or mine on top of it
+void drawTile(sf::RenderWindow& window, const TileTextures& textures, sf::Sprite& sprite, TileState state, int number, int x, int y) {
+    sprite.setPosition(static_cast<float>(x * 32), static_cast<float>(y * 32));
+    sprite.setTexture(state == TileState::Hidden ? textures.hidden : textures.revealed);
+    window.draw(sprite);
 
     switch (state) {
-    case TileState::Hidden:
-        sprite.setTexture(hiddenTexture);
-        break;
     case TileState::Revealed:
-        sprite.setTexture(revealedTexture);
-        break;
     case TileState::Number:
         if (number >= 1 && number <= 8) {
-            sprite.setTexture(numberTextures[number]);
+            sprite.setTexture(textures.numbers[number - 1]);
+            window.draw(sprite);
         }
         break;
     case TileState::Flag:
-        sprite.setTexture(flagTexture);  
+        sprite.setTexture(textures.flag);
+        window.draw(sprite);
         break;
     case TileState::Mine:
-        sprite.setTexture(mineTexture);
+        sprite.setTexture(textures.mine);
+        window.draw(sprite);
+        break;
+    default:
         break;
     }
 }
 
+// Class representing a tile on the Minesweeper board, only what is drawn for it
+class Tile {
+public:
+    Tile();
+    void setState(TileState newState, int newNumber = 0);
+    TileState getState() const;
+    int getNumber() const;
+    void draw(sf::RenderWindow& window, const TileTextures& textures, int x, int y) const;
+
+private:
+    TileState state;
+    unsigned char number;
+};
+
+Tile::Tile() : state(TileState::Hidden), number(0) {
+}
+
+void Tile::setState(TileState newState, int newNumber) {
+    state = newState;
+    number = static_cast<unsigned char>(newNumber);
+}
+
 TileState Tile::getState() const {
     return state;
 }
 
+int Tile::getNumber() const {
+    return number;
+}
 
-void Tile::draw(sf::RenderWindow& window, int x, int y) {
-    sf::RectangleShape tileBackground(sf::Vector2f(32.f, 32.f));
-    tileBackground.setPosition(static_cast<float>(x * 32), static_cast<float>(y * 32));
+void Tile::draw(sf::RenderWindow& window, const TileTextures& textures, int x, int y) const {
+    sf::Sprite sprite;
+    drawTile(window, textures, sprite, state, number, x, y);
+}
 
-    switch (state) {
-    case TileState::Hidden:
-        tileBackground.setTexture(&hiddenTexture);
-        window.draw(tileBackground);
-        break;
-    case TileState::Revealed: {
-        tileBackground.setTexture(&revealedTexture);
-        window.draw(tileBackground);
-        if (number >= 1 && number <= 8) {
-            // Draw the revealed number on top of the revealed tile
-            sf::Sprite numberSprite;
-            numberSprite.setTexture(numberTextures[number - 1]);
-            numberSprite.setPosition(static_cast<float>(x * 32), static_cast<float>(y * 32));
-            window.draw(numberSprite);
-        }
-        break;
-    }
-    case TileState::Number: {
-        // Draw the revealed texture for the background
-        tileBackground.setTexture(&revealedTexture);
-        window.draw(tileBackground);
+// Textures for the panel under the board
+struct PanelTextures {
+    sf::Texture faces[3]; // happy, win, lose, the same order as RenderFrame::face
+    sf::Texture buttons[4]; // debug, test 1, test 2, test 3
 
-        // Draw the number on top of the revealed tile
-        sf::Sprite numberSprite;
-        numberSprite.setTexture(numberTextures[number - 1]);
-        numberSprite.setPosition(static_cast<float>(x * 32), static_cast<float>(y * 32));
-        window.draw(numberSprite);
-        break;
-    }
-    case TileState::Flag: {
-        // Draw the revealed texture for the background of flags
-        tileBackground.setTexture(&revealedTexture);
-        window.draw(tileBackground);
+    void load();
+};
 
-        // Draw the flag on top of the revealed tile
-        sf::Sprite flagSprite;
-        flagSprite.setTexture(flagTexture);
-        flagSprite.setPosition(static_cast<float>(x * 32), static_cast<float>(y * 32));
-        window.draw(flagSprite);
-        break;
-    }
-    case TileState::Mine:
-        tileBackground.setTexture(&revealedTexture); 
-        window.draw(tileBackground);
-        sprite.setPosition(static_cast<float>(x * 32), static_cast<float>(y * 32));
-        window.draw(sprite);
-        break;
+void PanelTextures::load() {
+    faces[0].loadFromFile("images/face_happy.png");
+    faces[1].loadFromFile("images/face_win.png");
+    faces[2].loadFromFile("images/face_lose.png");
+
+    buttons[0].loadFromFile("images/debug.png");
+    buttons[1].loadFromFile("images/test_1.png");
+    buttons[2].loadFromFile("images/test_2.png");
+    buttons[3].loadFromFile("images/test_3.png");
+}
+
+// Function to place the face at the bottom center of the window and the debug and test
+// buttons to its right. Board and BoardRenderer both use it, so clicks land on what is drawn.
+void layoutPanel(sf::Sprite& faceSprite, sf::Sprite buttonSprites[4], int windowWidth, int windowHeight) {
+    float faceWidth = faceSprite.getGlobalBounds().width;
+    faceSprite.setPosition(static_cast<float>(windowWidth / 2 - faceWidth / 2), static_cast<float>(windowHeight - 1.25 * (faceSprite.getGlobalBounds().height)));
+
+    for (int i = 0; i < 4; ++i) {
+        buttonSprites[i].setPosition(static_cast<float>(windowWidth / 2 + faceWidth * (i + 2) + 16), static_cast<float>(windowHeight - 1.25 * (buttonSprites[i].getGlobalBounds().height)));
     }
 }
 
@@ -206,385 +221,1803 @@ bool readBoardFile(const  string& filename, vector<vector<bool>>& boardLayout) {
     return true;
 }
 
-// Class representing the Minesweeper board
-class Board {
-public:
-    Board(const ConfigValues& config, int width, int height);
-    void draw(sf::RenderWindow& window);
-    void handleLeftClick(sf::Vector2i position);
-    void handleRightClick(sf::Vector2i position);
-    void printNumbers() const;
-    bool isGameOver() const;
-    bool isGameWon() const;
-    int getRemainingMines() const;
-    void reset();
-    bool isDebugMode;
-    void initializeBoardFromLayout(const vector<vector<bool>>& boardLayout);
+// What the player has done to a tile
+enum class TileMark : unsigned char {
+    Hidden,
+    Revealed,
+    Flagged
+};
 
-private:
-    int columns;
-    int rows;
-    int mines;
-    int originalMines;
-    int flagsPlaced;
-    int windowWidth;
-    int windowHeight;
-    bool gameWon;
-    bool gameLost;
+// Mine, count and reveal state of a board, without any drawing. Tiles are given as
+// (x, y), planes passed in or out are row-major (y * columns + x).
+class BoardCore {
+public:
+    virtual ~BoardCore() {}
+    virtual int getColumns() const = 0;
+    virtual int getRows() const = 0;
+    virtual void setMines(const unsigned char* mines, const unsigned char* counts) = 0;
+    virtual void placeRandomMines(unsigned seed, int mines) = 0;
+    virtual bool hasMine(int x, int y) const = 0;
+    virtual int getCount(int x, int y) const = 0;
+    virtual TileMark getMark(int x, int y) const = 0;
+    virtual void setMark(int x, int y, TileMark mark) = 0;
+    virtual int reveal(int x, int y, vector<int>* revealed) = 0;
+    virtual int getMines() const = 0;
+    virtual int getRevealedTiles() const = 0;
+    virtual int getFlaggedSafeTiles() const = 0;
+    virtual bool isWon() const = 0;
+    // Planes in bulk, copied row by row. getPlanes fills rowCount rows from firstRow on
+    // and skips null outputs.
+    virtual void getPlanes(int firstRow, int rowCount, unsigned char* mines, unsigned char* counts, unsigned char* marks) const = 0;
+    virtual void setMarks(const unsigned char* marks) = 0;
+};
 
-    vector<vector<Tile>> grid;
-    vector<vector<bool>> hasMine;
-    vector<vector<int>> adjacentMineCounts;
-    vector<sf::Texture> digitTextures;
+// Board size known at compile time, so the offsets and strides below are constants
+template <int W, int H>
+class FixedShape {
+public:
+    typedef array<unsigned char, (W + 2) * (H + 2)> Plane;
+    typedef array<int, W * H> IndexList;
 
-    sf::Texture happyFaceTexture;
-    sf::Texture winFaceTexture;
-    sf::Texture loseFaceTexture;
-    sf::Sprite faceSprite;
-    sf::Texture debugButtonTexture;
-    sf::Sprite debugButtonSprite;
-    sf::Texture test1ButtonTexture;
-    sf::Sprite test1ButtonSprite;
-    sf::Texture test2ButtonTexture;
-    sf::Sprite test2ButtonSprite;
-    sf::Texture test3ButtonTexture;
-    sf::Sprite test3ButtonSprite;
+    FixedShape(int, int) {}
+    int getColumns() const { return W; }
+    int getRows() const { return H; }
+    int getStride() const { return W + 2; }
+    const array<int, 8>& getOffsets() const { return offsets; }
+    void resize(Plane&) const {}
+    void resize(IndexList&) const {}
 
-    void initializeDebugButton();
-    void drawDebugButton(sf::RenderWindow& window);
-    void handleDebugButtonClick(sf::Vector2i position);
-    void initializeBoard();
-    void placeMines();
-    void countAdjacentMines();
-    int getMineCount(int x, int y);
-    bool isMine(int x, int y) const;
-    void revealEmptyTiles(int x, int y);
-    void revealAllMinesFlags(int a);
-    void initializeFaceTextures();
-    void updateFaceTexture();
-    void hideAllMines();
+private:
+    static constexpr array<int, 8> offsets = { {
+        -(W + 2) - 1, -(W + 2), -(W + 2) + 1,
+        -1, 1,
+        (W + 2) - 1, (W + 2), (W + 2) + 1
+    } };
 };
 
-// Constructor for the Board class
-Board::Board(const ConfigValues& config, int width, int height)
-    : columns(config.columns), rows(config.rows), mines(config.mines), originalMines(config.mines), flagsPlaced(0), gameWon(false), gameLost(false), windowWidth(width), windowHeight(height), isDebugMode(false) {
-
-    grid.resize(columns, vector<Tile>(rows));
-
-    initializeBoard();
-    placeMines();
-    countAdjacentMines();
+template <int W, int H>
+constexpr array<int, 8> FixedShape<W, H>::offsets;
 
-    // Load digit textures
-    sf::Texture digitTexture;
-    digitTexture.loadFromFile("images/digits.png");  
+// Board size only known at run time
+class DynamicShape {
+public:
+    typedef vector<unsigned char> Plane;
+    typedef vector<int> IndexList;
 
-    // Split the digit texture into separate textures for each digit
-    int digitWidth = digitTexture.getSize().x / 10;  
-    int digitHeight = digitTexture.getSize().y;
-    digitTextures.resize(10);
+    DynamicShape(int columns, int rows);
+    int getColumns() const { return columns; }
+    int getRows() const { return rows; }
+    int getStride() const { return columns + 2; }
+    const array<int, 8>& getOffsets() const { return offsets; }
+    void resize(Plane& plane) const { plane.assign(static_cast<size_t>(columns + 2) * (rows + 2), 0); }
+    void resize(IndexList& list) const { list.resize(static_cast<size_t>(columns) * rows); }
 
-    for (int i = 0; i < 10; ++i) {
-        digitTextures[i].loadFromImage(digitTexture.copyToImage(), sf::IntRect(i * digitWidth, 0, digitWidth, digitHeight));
-    }
+private:
+    int columns;
+    int rows;
+    array<int, 8> offsets;
+};
 
-    initializeFaceTextures();
-    initializeDebugButton();
-    updateFaceTexture();
+DynamicShape::DynamicShape(int columns, int rows) : columns(columns), rows(rows) {
+    int stride = columns + 2;
+    offsets = { { -stride - 1, -stride, -stride + 1, -1, 1, stride - 1, stride, stride + 1 } };
 }
 
-void Board::initializeDebugButton() {
-    //debug button
-    debugButtonTexture.loadFromFile("images/debug.png");
-    debugButtonSprite.setTexture(debugButtonTexture);
-    debugButtonSprite.setPosition(static_cast<float>(windowWidth / 2 + faceSprite.getGlobalBounds().width * 2 + 16), static_cast<float>(windowHeight - 1.25 * (debugButtonSprite.getGlobalBounds().height)));
+// BoardCore on a grid padded by one tile on every side, so neighbours are read through
+// the offset table with no bounds checks. The padding counts as revealed and mine free.
+template <typename Shape>
+class GridBoard final : public BoardCore {
+public:
+    GridBoard(int columns = 0, int rows = 0);
+    int getColumns() const override { return shape.getColumns(); }
+    int getRows() const override { return shape.getRows(); }
+    void setMines(const unsigned char* mines, const unsigned char* counts) override;
+    void placeRandomMines(unsigned seed, int mines) override;
+    bool hasMine(int x, int y) const override { return mineCells[toIndex(x, y)] != 0; }
+    int getCount(int x, int y) const override { return counts[toIndex(x, y)]; }
+    TileMark getMark(int x, int y) const override { return static_cast<TileMark>(marks[toIndex(x, y)]); }
+    void setMark(int x, int y, TileMark mark) override;
+    int reveal(int x, int y, vector<int>* revealed) override;
+    int getMines() const override { return mines; }
+    int getRevealedTiles() const override { return revealedTiles; }
+    int getFlaggedSafeTiles() const override { return flaggedSafeTiles; }
+    bool isWon() const override { return revealedTiles == getColumns() * getRows() - mines; }
+    void getPlanes(int firstRow, int rowCount, unsigned char* mines, unsigned char* counts, unsigned char* marks) const override;
+    void setMarks(const unsigned char* marks) override;
 
-    //test buttons
-    test1ButtonTexture.loadFromFile("images/test_1.png");
-    test1ButtonSprite.setTexture(test1ButtonTexture);
-    test1ButtonSprite.setPosition(static_cast<float>(windowWidth / 2 + faceSprite.getGlobalBounds().width * 3 + 16), static_cast<float>(windowHeight - 1.25 * (test1ButtonSprite.getGlobalBounds().height)));
+private:
+    Shape shape;
+    typename Shape::Plane mineCells;
+    typename Shape::Plane counts;
+    typename Shape::Plane marks;
+    typename Shape::IndexList indices; // shuffle buffer and flood fill stack
+    int mines;
+    int revealedTiles;
+    int flaggedSafeTiles;
 
-    test2ButtonTexture.loadFromFile("images/test_2.png");
-    test2ButtonSprite.setTexture(test2ButtonTexture);
-    test2ButtonSprite.setPosition(static_cast<float>(windowWidth / 2 + faceSprite.getGlobalBounds().width * 4 + 16), static_cast<float>(windowHeight - 1.25 * (test2ButtonSprite.getGlobalBounds().height)));
+    int toIndex(int x, int y) const { return (y + 1) * shape.getStride() + x + 1; }
+    void clearMarks();
+    void countNeighbours();
+};
 
-    test3ButtonTexture.loadFromFile("images/test_3.png");
-    test3ButtonSprite.setTexture(test3ButtonTexture);
-    test3ButtonSprite.setPosition(static_cast<float>(windowWidth / 2 + faceSprite.getGlobalBounds().width * 5 + 16), static_cast<float>(windowHeight - 1.25 * (test3ButtonSprite.getGlobalBounds().height)));
+template <int W, int H>
+using FixedBoard = GridBoard<FixedShape<W, H>>;
+typedef GridBoard<DynamicShape> DynamicBoard;
+
+template <typename Shape>
+GridBoard<Shape>::GridBoard(int columns, int rows)
+    : shape(columns, rows), mines(0), revealedTiles(0), flaggedSafeTiles(0) {
+    shape.resize(mineCells);
+    shape.resize(counts);
+    shape.resize(marks);
+    shape.resize(indices);
+    setMines(nullptr, nullptr);
 }
 
-void Board::drawDebugButton(sf::RenderWindow& window) {
-    window.draw(debugButtonSprite);
-
-    //test buttons
-    window.draw(test1ButtonSprite);
-    window.draw(test2ButtonSprite);
-    window.draw(test3ButtonSprite);
+// Function to hide every tile, with the padding marked revealed so flood fills stop there
+template <typename Shape>
+void GridBoard<Shape>::clearMarks() {
+    fill(marks.begin(), marks.end(), static_cast<unsigned char>(TileMark::Revealed));
+    for (int y = 0; y < getRows(); ++y) {
+        fill(marks.begin() + toIndex(0, y), marks.begin() + toIndex(0, y) + getColumns(), static_cast<unsigned char>(TileMark::Hidden));
+    }
+    revealedTiles = 0;
+    flaggedSafeTiles = 0;
 }
 
-void Board::hideAllMines() {
-    for (int x = 0; x < columns; ++x) {
-        for (int y = 0; y < rows; ++y) {
-            if (hasMine[x][y]) {
-                // If a tile contains a mine, set its state to Mine
-                grid[x][y].setState(TileState::Hidden);
+// Function to start a new game with the given mines, counting neighbours unless counts are
+// passed in too (mines keep a count of 0). A null mine plane leaves the board empty.
+template <typename Shape>
+void GridBoard<Shape>::setMines(const unsigned char* mineData, const unsigned char* countData) {
+    const int columns = getColumns();
+    fill(mineCells.begin(), mineCells.end(), static_cast<unsigned char>(0));
+    fill(counts.begin(), counts.end(), static_cast<unsigned char>(0));
+    mines = 0;
+
+    if (mineData) {
+        for (int y = 0; y < getRows(); ++y) {
+            memcpy(&mineCells[toIndex(0, y)], mineData + static_cast<size_t>(y) * columns, columns);
+            mines += static_cast<int>(count(mineData + static_cast<size_t>(y) * columns, mineData + static_cast<size_t>(y + 1) * columns, 1));
+        }
+
+        if (countData) {
+            for (int y = 0; y < getRows(); ++y) {
+                memcpy(&counts[toIndex(0, y)], countData + static_cast<size_t>(y) * columns, columns);
             }
         }
+        else {
+            countNeighbours();
+        }
     }
-}
 
-void Board::initializeFaceTextures() {
-    happyFaceTexture.loadFromFile("images/face_happy.png");
-    winFaceTexture.loadFromFile("images/face_win.png");
-    loseFaceTexture.loadFromFile("images/face_lose.png");
-    faceSprite.setTexture(happyFaceTexture);
+    clearMarks();
 }
 
-void Board::updateFaceTexture() {
-    if (gameWon) {
-        faceSprite.setTexture(winFaceTexture);
-    }
-    else if (gameLost) {
-        faceSprite.setTexture(loseFaceTexture);
+// Function to start a new game with mines placed by a partial shuffle of the tiles
+template <typename Shape>
+void GridBoard<Shape>::placeRandomMines(unsigned seed, int mineCount) {
+    const int size = getColumns() * getRows();
+
+    mt19937 rng(seed);
+    for (int i = 0; i < size; ++i) {
+        indices[i] = i;
     }
-    else {
-        faceSprite.setTexture(happyFaceTexture);
+    mineCount = min(mineCount, size);
+
+    fill(mineCells.begin(), mineCells.end(), static_cast<unsigned char>(0));
+    for (int i = 0; i < mineCount; ++i) {
+        int j = uniform_int_distribution<int>(i, size - 1)(rng);
+        swap(indices[i], indices[j]);
+        mineCells[toIndex(indices[i] % getColumns(), indices[i] / getColumns())] = 1;
     }
+    mines = mineCount;
 
-    // Set the position of the face sprite at the bottom center of the window
-    faceSprite.setPosition(static_cast<float>(windowWidth / 2 - faceSprite.getGlobalBounds().width / 2), static_cast<float>(windowHeight - 1.25 * (faceSprite.getGlobalBounds().height)));
+    countNeighbours();
+    clearMarks();
 }
 
-void Board::draw(sf::RenderWindow& window) {
-    // Draw the board
-    for (int x = 0; x < columns; ++x) {
-        for (int y = 0; y < rows; ++y) {
-            grid[x][y].draw(window, x, y);
+// Function to count adjacent mines for every tile, a row at a time from the three rows
+// around it. The padding rows and columns hold no mines, so no bounds checks are needed.
+// Mines keep a count of 0. Written branch free on bytes so the row loop vectorizes.
+template <typename Shape>
+void GridBoard<Shape>::countNeighbours() {
+    const int columns = getColumns();
+    const int stride = shape.getStride();
+
+    for (int y = 0; y < getRows(); ++y) {
+        const unsigned char* current = &mineCells[toIndex(-1, y)];
+        const unsigned char* above = current - stride;
+        const unsigned char* below = current + stride;
+        unsigned char* rowCounts = &counts[toIndex(0, y)];
+        for (int x = 0; x < columns; ++x) {
+            unsigned char sum = static_cast<unsigned char>(above[x] + above[x + 1] + above[x + 2] +
+                current[x] + current[x + 2] + below[x] + below[x + 1] + below[x + 2]);
+            // current[x + 1] - 1 is 0xff for a safe tile and 0 for a mine
+            rowCounts[x] = static_cast<unsigned char>(sum & static_cast<unsigned char>(current[x + 1] - 1));
         }
     }
-
-    // Draw the happy face
-    window.draw(faceSprite);
-
-    // Draw the debug button
-    drawDebugButton(window);
 }
 
-// initialize the Minesweeper board
-void Board::initializeBoard() {
-    // Set all tiles to Hidden initially
-    for (int y = 0; y < rows; ++y) {
-        for (int x = 0; x < columns; ++x) {
-            grid[x][y].setState(TileState::Hidden);
+// Function to copy rows of the mine, count and mark planes out, row-major without the padding
+template <typename Shape>
+void GridBoard<Shape>::getPlanes(int firstRow, int rowCount, unsigned char* mineData, unsigned char* countData, unsigned char* markData) const {
+    const int columns = getColumns();
+    for (int y = firstRow; y < firstRow + rowCount; ++y) {
+        size_t row = static_cast<size_t>(y - firstRow) * columns;
+        if (mineData) {
+            memcpy(mineData + row, &mineCells[toIndex(0, y)], columns);
+        }
+        if (countData) {
+            memcpy(countData + row, &counts[toIndex(0, y)], columns);
+        }
+        if (markData) {
+            memcpy(markData + row, &marks[toIndex(0, y)], columns);
         }
     }
 }
 
-// initializes the board that was loaded from one of the files
-void Board::initializeBoardFromLayout(const vector<vector<bool>>& boardLayout) {
-    // Set all tiles to Hidden initially
-    for (int y = 0; y < rows; ++y) {
+// Function to set every tile's mark from a row-major plane of TileMark values, for
+// restoring saved games. The mines have to be in place first.
+template <typename Shape>
+void GridBoard<Shape>::setMarks(const unsigned char* markData) {
+    const int columns = getColumns();
+    const unsigned char revealedMark = static_cast<unsigned char>(TileMark::Revealed);
+    const unsigned char flaggedMark = static_cast<unsigned char>(TileMark::Flagged);
+    int revealed = 0;
+    int flaggedSafe = 0;
+
+    for (int y = 0; y < getRows(); ++y) {
+        const unsigned char* source = markData + static_cast<size_t>(y) * columns;
+        const unsigned char* rowMines = &mineCells[toIndex(0, y)];
+        memcpy(&marks[toIndex(0, y)], source, columns);
+        int rowRevealed = 0;
+        int rowFlaggedSafe = 0;
         for (int x = 0; x < columns; ++x) {
-            grid[x][y].setState(TileState::Hidden);
+            rowRevealed += source[x] == revealedMark;
+            rowFlaggedSafe += (source[x] == flaggedMark) & (rowMines[x] == 0);
         }
+        revealed += rowRevealed;
+        flaggedSafe += rowFlaggedSafe;
     }
 
-    // Resize and initialize hasMine vector
-    hasMine.resize(columns, vector<bool>(rows, false));
+    revealedTiles = revealed;
+    flaggedSafeTiles = flaggedSafe;
+}
 
-    // Set mine and non-mine tiles based on the layout
-    int mineCount = 0; //count the number of mines
+// Function to set a tile's mark directly, for flags and restoring saved games
+template <typename Shape>
+void GridBoard<Shape>::setMark(int x, int y, TileMark mark) {
+    int index = toIndex(x, y);
+    TileMark old = static_cast<TileMark>(marks[index]);
+    revealedTiles += (mark == TileMark::Revealed) - (old == TileMark::Revealed);
+    if (!mineCells[index]) {
+        flaggedSafeTiles += (mark == TileMark::Flagged) - (old == TileMark::Flagged);
+    }
+    marks[index] = static_cast<unsigned char>(mark);
+}
 
-    for (int y = 0; y < rows; ++y) {
-        for (int x = 0; x < columns; ++x) {
-            if (boardLayout[y][x]) {
-                // Set as mine
-                hasMine[x][y] = true;
-                mineCount++;
-            }
-            else {
-                // Clear mine
-                hasMine[x][y] = false;
+// Function to reveal a hidden tile, flood filling zeros. Flags stop the fill. Returns -1 for
+// a mine, otherwise the number of tiles revealed, which are appended to revealed if given.
+template <typename Shape>
+int GridBoard<Shape>::reveal(int x, int y, vector<int>* revealed) {
+    int start = toIndex(x, y);
+    if (marks[start] != static_cast<unsigned char>(TileMark::Hidden)) {
+        return 0;
+    }
+    if (mineCells[start]) {
+        return -1;
+    }
+
+    const array<int, 8>& offsets = shape.getOffsets();
+    const int stride = shape.getStride();
+    int top = 0;
+    int newlyRevealed = 0;
+    marks[start] = static_cast<unsigned char>(TileMark::Revealed);
+    indices[top++] = start;
+    while (top > 0) {
+        int index = indices[--top];
+        newlyRevealed++;
+        if (revealed) {
+            revealed->push_back((index / stride - 1) * getColumns() + index % stride - 1);
+        }
+        if (counts[index] != 0) {
+            continue;
+        }
+        // A zero has no mines around it, so every hidden neighbour is safe
+        for (int offset : offsets) {
+            int neighbour = index + offset;
+            if (marks[neighbour] == static_cast<unsigned char>(TileMark::Hidden)) {
+                marks[neighbour] = static_cast<unsigned char>(TileMark::Revealed);
+                indices[top++] = neighbour;
             }
         }
     }
 
-    countAdjacentMines(); 
-    mines = mineCount; // Update the total number of mines
+    revealedTiles += newlyRevealed;
+    return newlyRevealed;
 }
 
-// Function to place mines randomly on the board
-void Board::placeMines() {
-    srand(static_cast<unsigned>(time(0))); // Seed the random number generator
+// Function to make the core for a configuration: a fixed size board for the standard
+// beginner, intermediate and expert sizes and the default config.cfg size, DynamicBoard
+// for anything else
+unique_ptr<BoardCore> makeBoardCore(const ConfigValues& config) {
+    if (config.columns == 9 && config.rows == 9) {
+        return unique_ptr<BoardCore>(new FixedBoard<9, 9>());
+    }
+    if (config.columns == 16 && config.rows == 16) {
+        return unique_ptr<BoardCore>(new FixedBoard<16, 16>());
+    }
+    if (config.columns == 30 && config.rows == 16) {
+        return unique_ptr<BoardCore>(new FixedBoard<30, 16>());
+    }
+    if (config.columns == 25 && config.rows == 16) {
+        return unique_ptr<BoardCore>(new FixedBoard<25, 16>());
+    }
+    return unique_ptr<BoardCore>(new DynamicBoard(config.columns, config.rows));
+}
+
+// A mine layout made by the board generator, stored row-major (y * columns + x)
+struct GeneratedBoard {
+    int columns;
+    int rows;
+    int mines;
+    unsigned seed;
+    int startX; // safe opening tile, always has no adjacent mines
+    int startY;
+    bool noGuess; // true if the solver cleared the board from the opening
+    vector<unsigned char> hasMine;
+    vector<unsigned char> counts; // adjacent mine counts, 0 for mines
+};
+
+// Bounded lock-free queue, any number of producers and consumers
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity);
+    bool tryPush(T& value);
+    bool tryPop(T& value);
 
-    hasMine.resize(columns, vector<bool>(rows, false));
+private:
+    struct Cell {
+        atomic<size_t> sequence;
+        T value;
+    };
+
+    unique_ptr<Cell[]> cells;
+    size_t mask;
+    atomic<size_t> enqueuePos;
+    atomic<size_t> dequeuePos;
+};
 
-    int minesToPlace = mines;
-    while (minesToPlace > 0) {
-        int x = rand() % columns;
-        int y = rand() % rows;
+template <typename T>
+BoundedQueue<T>::BoundedQueue(size_t capacity) : enqueuePos(0), dequeuePos(0) {
+    // Round the capacity up to a power of two so positions can be masked
+    size_t size = 2;
+    while (size < capacity) {
+        size *= 2;
+    }
+    mask = size - 1;
 
-        if (!hasMine[x][y]) {
-            hasMine[x][y] = true;
-            --minesToPlace;
-        }
+    cells.reset(new Cell[size]);
+    for (size_t i = 0; i < size; ++i) {
+        cells[i].sequence.store(i, memory_order_relaxed);
     }
 }
 
-// Function to count the number of adjacent mines for each tile
-void Board::countAdjacentMines() {
-    adjacentMineCounts.resize(columns, vector<int>(rows, 0));
-
-    for (int x = 0; x < columns; ++x) {
-        for (int y = 0; y < rows; ++y) {
-            if (!hasMine[x][y]) {
-                int mineCount = getMineCount(x, y);
-                adjacentMineCounts[x][y] = mineCount;
+// Moves value into the queue, returns false if the queue is full
+template <typename T>
+bool BoundedQueue<T>::tryPush(T& value) {
+    size_t pos = enqueuePos.load(memory_order_relaxed);
+    for (;;) {
+        Cell& cell = cells[pos & mask];
+        size_t sequence = cell.sequence.load(memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+
+        if (diff == 0) {
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) {
+                cell.value = std::move(value);
+                cell.sequence.store(pos + 1, memory_order_release);
+                return true;
             }
         }
+        else if (diff < 0) {
+            return false;
+        }
+        else {
+            pos = enqueuePos.load(memory_order_relaxed);
+        }
     }
 }
 
-// Function to print out the numbers for each tile, for debugging purposes
-void Board::printNumbers() const {
-    for (int y = 0; y < rows; ++y) {
-        for (int x = 0; x < columns; ++x) {
-            cout << adjacentMineCounts[x][y] << " ";
+// Moves the oldest element into value, returns false if the queue is empty
+template <typename T>
+bool BoundedQueue<T>::tryPop(T& value) {
+    size_t pos = dequeuePos.load(memory_order_relaxed);
+    for (;;) {
+        Cell& cell = cells[pos & mask];
+        size_t sequence = cell.sequence.load(memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+
+        if (diff == 0) {
+            if (dequeuePos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) {
+                value = std::move(cell.value);
+                cell.sequence.store(pos + mask + 1, memory_order_release);
+                return true;
+            }
+        }
+        else if (diff < 0) {
+            return false;
+        }
+        else {
+            pos = dequeuePos.load(memory_order_relaxed);
         }
-        cout << endl;
     }
 }
 
-// Function to get the number of adjacent mines for a given tile
-int Board::getMineCount(int x, int y) {
-    int count = 0;
-
-    for (int dx = -1; dx <= 1; ++dx) {
-        for (int dy = -1; dy <= 1; ++dy) {
-            int nx = x + dx;
-            int ny = y + dy;
-
-            if (nx >= 0 && nx < columns && ny >= 0 && ny < rows && hasMine[nx][ny]) {
-                count++;
-            }
+// Rows per generation band. Fixed so the result for a seed never depends on the thread count.
+const int generationBandRows = 64;
+
+// Function to run work(band) for every band, spreading the bands over threadCount threads.
+// This is a plain fork/join rather than a pool: the extra threads are started for the call
+// and joined before it returns. Starting a thread costs tens of microseconds, which is
+// small next to a band pass on the boards big enough to have more than one band.
+template <typename Work>
+void forkJoinBands(int bandCount, int threadCount, Work work) {
+    threadCount = max(1, min(threadCount, bandCount));
+    if (threadCount == 1) {
+        for (int band = 0; band < bandCount; ++band) {
+            work(band);
         }
+        return;
     }
-    return count;
-}
 
-int Board::getRemainingMines() const {
-    // Calculate remaining mines by subtracting flagsPlaced from the total mines
-    return mines - flagsPlaced;
-}
+    atomic<int> nextBand(0);
+    auto worker = [&]() {
+        for (int band = nextBand++; band < bandCount; band = nextBand++) {
+            work(band);
+        }
+    };
 
-// Function to check if a given tile is a mine
-bool Board::isMine(int x, int y) const {
-    return (grid[x][y].getState() == TileState::Mine);
+    vector<thread> threads;
+    for (int i = 1; i < threadCount; ++i) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (thread& t : threads) {
+        t.join();
+    }
 }
 
-// Function to reveal empty tiles and adjacent tiles
-void Board::revealEmptyTiles(int x, int y) {
-    if (x < 0 || x >= columns || y < 0 || y >= rows || grid[x][y].getState() != TileState::Hidden) {
-        // Check if the coordinates are within the valid range and the tile is hidden
-        return;
+// Function to count the mines among `draws` tiles taken at random from `tiles` tiles
+// holding `mines` mines (a hypergeometric draw). Inverts the distribution walking outward
+// from the mode, so it takes about one step per standard deviation.
+long long drawHypergeometric(mt19937& rng, long long tiles, long long mines, long long draws) {
+    long long low = max(0LL, draws - (tiles - mines));
+    long long high = min(draws, mines);
+    if (low == high) {
+        return low;
     }
 
-    Tile& currentTile = grid[x][y];
+    auto logChoose = [](long long n, long long k) {
+        return lgamma(n + 1.0) - lgamma(k + 1.0) - lgamma(n - k + 1.0);
+    };
 
-    if (currentTile.getState() == TileState::Hidden) {
-        // Reveal the current tile and its number
-        currentTile.setState(TileState::Revealed, adjacentMineCounts[x][y]);
+    long long mode = (draws + 1) * (mines + 1) / (tiles + 2);
+    mode = min(max(mode, low), high);
 
-        // Check if the current tile has no adjacent mines
-        if (getMineCount(x, y) == 0) {
-            // Reveal adjacent tiles
-            for (int dx = -1; dx <= 1; ++dx) {
-                for (int dy = -1; dy <= 1; ++dy) {
-                    int nx = x + dx;
-                    int ny = y + dy;
-                    // Only reveal the adjacent tile if it's hidden and not a mine
-                    if (nx >= 0 && nx < columns && ny >= 0 && ny < rows && !hasMine[nx][ny]) {
-                        revealEmptyTiles(nx, ny);
-                    }
-                }
+    double modeProbability = exp(logChoose(mines, mode) + logChoose(tiles - mines, draws - mode) - logChoose(tiles, draws));
+    double u = uniform_real_distribution<double>(0.0, 1.0)(rng);
+    double total = modeProbability;
+    if (u < total) {
+        return mode;
+    }
+
+    long long up = mode;
+    long long down = mode;
+    double upProbability = modeProbability;
+    double downProbability = modeProbability;
+    while (up < high || down > low) {
+        if (up < high) {
+            upProbability *= static_cast<double>(mines - up) * (draws - up) / (static_cast<double>(up + 1) * (tiles - mines - draws + up + 1));
+            ++up;
+            total += upProbability;
+            if (u < total) {
+                return up;
+            }
+        }
+        if (down > low) {
+            downProbability *= static_cast<double>(down) * (tiles - mines - draws + down) / (static_cast<double>(mines - down + 1) * (draws - down + 1));
+            --down;
+            total += downProbability;
+            if (u < total) {
+                return down;
             }
         }
     }
+    // Only reachable through rounding in the running total
+    return mode;
 }
 
-// Function to handle left-click events on the Minesweeper board
-void Board::handleLeftClick(sf::Vector2i position) {
-    // Check if the happy face is clicked
-    sf::FloatRect faceBounds = faceSprite.getGlobalBounds();
-    if (faceBounds.contains(static_cast<float>(position.x), static_cast<float>(position.y))) {
-        reset();
-        isDebugMode = false;
-        return;
+// Function to place mines for one attempt, keeping the 3x3 area around the opening clear.
+// The seed picks the opening and splits the mines between bands, then each band places
+// its share with its own generator, so bands can be filled in parallel.
+void placeGeneratedMines(GeneratedBoard& board, int threadCount = 1) {
+    const int columns = board.columns;
+    const int rows = board.rows;
+    const int bandCount = (rows + generationBandRows - 1) / generationBandRows;
+
+    mt19937 rng(board.seed);
+    board.startX = uniform_int_distribution<int>(0, columns - 1)(rng);
+    board.startY = uniform_int_distribution<int>(0, rows - 1)(rng);
+
+    // Tiles of the opening area that fall inside rows [y0, y1)
+    auto openingTiles = [&](int y0, int y1) {
+        int x0 = max(0, board.startX - 1);
+        int x1 = min(columns - 1, board.startX + 1);
+        int top = max(y0, board.startY - 1);
+        int bottom = min(y1 - 1, board.startY + 1);
+        return bottom < top ? 0 : (x1 - x0 + 1) * (bottom - top + 1);
+    };
+
+    // Tiles in each band that may hold a mine
+    vector<long long> bandTiles(bandCount + 1, 0);
+    for (int band = 0; band < bandCount; ++band) {
+        int y0 = band * generationBandRows;
+        int y1 = min(rows, y0 + generationBandRows);
+        bandTiles[band + 1] = bandTiles[band] + static_cast<long long>(columns) * (y1 - y0) - openingTiles(y0, y1);
     }
 
-    // Check if the debug button is clicked
-    sf::FloatRect debugButtonBounds = debugButtonSprite.getGlobalBounds();
-    if (debugButtonBounds.contains(static_cast<float>(position.x), static_cast<float>(position.y))) {
-        if (gameWon || gameLost) {
-            return;
-        }
-        // Toggle debug mode
-        isDebugMode = !isDebugMode;
-
-        if (isDebugMode) {
-            // If entering debug mode, reveal all mines, 1 is for mines 0 for flags
-            revealAllMinesFlags(1);
-        }
-        else {
-            // If exiting debug mode, hide all mines
-            hideAllMines();
+    // Split the mines between bands by halving the band range again and again. The first
+    // half's share is a hypergeometric draw, the split a uniform layout would give.
+    vector<int> bandMines(bandCount, 0);
+    struct BandRange {
+        int first;
+        int last;
+        long long mines;
+    };
+    vector<BandRange> ranges(1, BandRange{ 0, bandCount, min(static_cast<long long>(board.mines), bandTiles[bandCount]) });
+    while (!ranges.empty()) {
+        BandRange range = ranges.back();
+        ranges.pop_back();
+        if (range.last - range.first == 1) {
+            bandMines[range.first] = static_cast<int>(range.mines);
+            continue;
         }
-        return; 
+        int middle = (range.first + range.last) / 2;
+        long long tiles = bandTiles[range.last] - bandTiles[range.first];
+        long long firstTiles = bandTiles[middle] - bandTiles[range.first];
+        long long firstMines = drawHypergeometric(rng, tiles, range.mines, firstTiles);
+        ranges.push_back(BandRange{ middle, range.last, range.mines - firstMines });
+        ranges.push_back(BandRange{ range.first, middle, firstMines });
     }
 
-    sf::FloatRect test1ButtonBounds = test1ButtonSprite.getGlobalBounds();
-    if (test1ButtonBounds.contains(static_cast<float>(position.x), static_cast<float>(position.y))) {
-        // Load and initialize the first test board (testboard1.brd)
-        vector<vector<bool>> boardLayout;
-        if (readBoardFile("boards/testboard1.brd", boardLayout)) {
-            reset();
-            initializeBoardFromLayout(boardLayout);
+    board.hasMine.assign(static_cast<size_t>(columns) * rows, 0);
 
+    forkJoinBands(bandCount, threadCount, [&](int band) {
+        int y0 = band * generationBandRows;
+        int y1 = min(rows, y0 + generationBandRows);
+
+        // Tiles in this band that may hold a mine (everything outside the opening)
+        vector<int> candidates;
+        candidates.reserve(static_cast<size_t>(columns) * (y1 - y0));
+        for (int y = y0; y < y1; ++y) {
+            for (int x = 0; x < columns; ++x) {
+                if (abs(x - board.startX) > 1 || abs(y - board.startY) > 1) {
+                    candidates.push_back(y * columns + x);
+                }
+            }
         }
-        else {
-            cerr << "Failed to load Test Board 1." << endl;
+
+        // Partial shuffle, the first bandMines candidates become mines
+        seed_seq bandSeed{ board.seed, static_cast<unsigned>(band) };
+        mt19937 bandRng(bandSeed);
+        for (int i = 0; i < bandMines[band]; ++i) {
+            int j = uniform_int_distribution<int>(i, static_cast<int>(candidates.size()) - 1)(bandRng);
+            swap(candidates[i], candidates[j]);
+            board.hasMine[candidates[i]] = 1;
+        }
+    });
+}
+
+// Function to count adjacent mines for every tile of a generated board, band by band.
+// Each band reads one halo row above and below it, which is safe since placement is done.
+void countGeneratedMines(GeneratedBoard& board, int threadCount = 1) {
+    const int columns = board.columns;
+    const int rows = board.rows;
+    const int bandCount = (rows + generationBandRows - 1) / generationBandRows;
+    const unsigned char* mines = board.hasMine.data();
+
+    board.counts.assign(static_cast<size_t>(columns) * rows, 0);
+
+    forkJoinBands(bandCount, threadCount, [&](int band) {
+        int y0 = band * generationBandRows;
+        int y1 = min(rows, y0 + generationBandRows);
+
+        // Column sums of the three rows around y, padded by one on each side
+        vector<unsigned char> columnSums(columns + 2, 0);
+
+        for (int y = y0; y < y1; ++y) {
+            const unsigned char* above = y > 0 ? mines + static_cast<size_t>(y - 1) * columns : nullptr;
+            const unsigned char* current = mines + static_cast<size_t>(y) * columns;
+            const unsigned char* below = y + 1 < rows ? mines + static_cast<size_t>(y + 1) * columns : nullptr;
+            unsigned char* counts = board.counts.data() + static_cast<size_t>(y) * columns;
+
+            for (int x = 0; x < columns; ++x) {
+                columnSums[x + 1] = static_cast<unsigned char>(current[x] + (above ? above[x] : 0) + (below ? below[x] : 0));
+            }
+            for (int x = 0; x < columns; ++x) {
+                // Mines keep a count of 0, the same as BoardCore::setMines
+                int sum = columnSums[x] + columnSums[x + 1] + columnSums[x + 2];
+                counts[x] = current[x] ? 0 : static_cast<unsigned char>(sum);
+            }
+        }
+    });
+}
+
+// Function to check that a board can be cleared from its opening without guessing.
+// Uses the single tile rule and, when that gets stuck, the subset rule between
+// pairs of nearby numbers. Both rules only look at numbers whose neighbourhood
+// changed, so the work stays proportional to the frontier. Gives up, returning false, as
+// soon as *stopping is set.
+bool isSolvableWithoutGuessing(const GeneratedBoard& board, const atomic<bool>* stopping = nullptr) {
+    const int columns = board.columns;
+    const int rows = board.rows;
+    const int size = columns * rows;
+
+    // Reveals and flags go through the same core the game uses
+    DynamicBoard core(columns, rows);
+    core.setMines(board.hasMine.data(), board.counts.data());
+    const vector<unsigned char>& counts = board.counts;
+    const int safeTiles = size - core.getMines();
+
+    // Numbers whose neighbourhood changed, for the single tile rule and for the subset rule
+    // A tile sits in each list at most once: bit 0 of queued is for pending, bit 1 for subsetPending
+    vector<int> pending;
+    vector<int> subsetPending;
+    vector<unsigned char> queued(size, 0);
+
+    auto touch = [&](int index) {
+        if (queued[index] == 3) {
+            return;
+        }
+        if (!(queued[index] & 1)) {
+            pending.push_back(index);
+        }
+        if (!(queued[index] & 2)) {
+            subsetPending.push_back(index);
+        }
+        queued[index] = 3;
+    };
+
+    // Queue the revealed numbers around a tile that was just revealed or flagged. Zeros
+    // never have hidden neighbours, so they are left out.
+    auto touchRevealedNeighbours = [&](int index) {
+        int x = index % columns;
+        int y = index / columns;
+        for (int dy = -1; dy <= 1; ++dy) {
+            for (int dx = -1; dx <= 1; ++dx) {
+                int nx = x + dx;
+                int ny = y + dy;
+                if (nx >= 0 && nx < columns && ny >= 0 && ny < rows && counts[ny * columns + nx] != 0 &&
+                    core.getMark(nx, ny) == TileMark::Revealed) {
+                    touch(ny * columns + nx);
+                }
+            }
+        }
+    };
+
+    // Reveal a tile with the core's flood fill, then queue the numbers it changed
+    vector<int> revealed;
+    auto reveal = [&](int index) {
+        revealed.clear();
+        core.reveal(index % columns, index / columns, &revealed);
+        for (int tile : revealed) {
+            touchRevealedNeighbours(tile);
         }
+    };
+
+    // Collect the hidden neighbours of a tile and the mines still unaccounted for
+    auto hiddenNeighbours = [&](int x, int y, vector<int>& hidden) {
+        hidden.clear();
+        int flags = 0;
+        for (int dy = -1; dy <= 1; ++dy) {
+            for (int dx = -1; dx <= 1; ++dx) {
+                int nx = x + dx;
+                int ny = y + dy;
+                if (nx < 0 || nx >= columns || ny < 0 || ny >= rows) {
+                    continue;
+                }
+                TileMark mark = core.getMark(nx, ny);
+                if (mark == TileMark::Hidden) {
+                    hidden.push_back(ny * columns + nx);
+                }
+                else if (mark == TileMark::Flagged) {
+                    flags++;
+                }
+            }
+        }
+        return counts[y * columns + x] - flags;
+    };
+
+    auto flag = [&](int index) {
+        core.setMark(index % columns, index / columns, TileMark::Flagged);
+        touchRevealedNeighbours(index);
+    };
+
+    // Subset rule: if the small set of hidden tiles is all next to the big one, the
+    // rest of the big set holds exactly bigRemaining - smallRemaining mines
+    vector<int> difference;
+    auto applySubsetRule = [&](const vector<int>& small, int smallRemaining, const vector<int>& big, int bigRemaining) {
+        if (small.empty() || big.size() <= small.size()) {
+            return false;
+        }
+        // Both lists are in scan order, so includes() works directly
+        if (!includes(big.begin(), big.end(), small.begin(), small.end())) {
+            return false;
+        }
+        difference.clear();
+        set_difference(big.begin(), big.end(), small.begin(), small.end(), back_inserter(difference));
+
+        int differenceMines = bigRemaining - smallRemaining;
+        if (differenceMines == 0) {
+            for (int tile : difference) {
+                reveal(tile);
+            }
+            return true;
+        }
+        if (differenceMines == static_cast<int>(difference.size())) {
+            for (int tile : difference) {
+                flag(tile);
+            }
+            return true;
+        }
+        return false;
+    };
+
+    reveal(board.startY * columns + board.startX);
+
+    vector<int> hidden;
+    vector<int> otherHidden;
+    // Polled every few thousand steps, a single pass of either rule can take seconds on
+    // a huge board
+    int stepsUntilCheck = 0;
+    auto stopRequested = [&]() {
+        if (--stepsUntilCheck > 0) {
+            return false;
+        }
+        stepsUntilCheck = 4096;
+        return stopping && *stopping;
+    };
+
+    while (core.getRevealedTiles() < safeTiles) {
+        // Single tile rule
+        while (!pending.empty()) {
+            if (stopRequested()) {
+                return false;
+            }
+            int index = pending.back();
+            pending.pop_back();
+            queued[index] &= ~1;
+            int x = index % columns;
+            int y = index / columns;
+            if (core.getMark(x, y) != TileMark::Revealed) {
+                continue;
+            }
+            int remaining = hiddenNeighbours(x, y, hidden);
+            if (hidden.empty()) {
+                continue;
+            }
+            if (remaining == 0) {
+                for (int neighbour : hidden) {
+                    reveal(neighbour);
+                }
+            }
+            else if (remaining == static_cast<int>(hidden.size())) {
+                for (int neighbour : hidden) {
+                    flag(neighbour);
+                }
+            }
+        }
+
+        if (core.getRevealedTiles() == safeTiles) {
+            break;
+        }
+
+        // Subset rule, pairing each changed number with every number within two tiles.
+        // A pair that failed before can only succeed after one of its two numbers changes.
+        bool progress = false;
+        while (!subsetPending.empty() && !progress) {
+            if (stopRequested()) {
+                return false;
+            }
+            int index = subsetPending.back();
+            subsetPending.pop_back();
+            queued[index] &= ~2;
+            int x = index % columns;
+            int y = index / columns;
+            if (core.getMark(x, y) != TileMark::Revealed) {
+                continue;
+            }
+            int remaining = hiddenNeighbours(x, y, hidden);
+            if (hidden.empty()) {
+                continue;
+            }
+            for (int dy = -2; dy <= 2 && !progress; ++dy) {
+                for (int dx = -2; dx <= 2 && !progress; ++dx) {
+                    int nx = x + dx;
+                    int ny = y + dy;
+                    if ((dx == 0 && dy == 0) || nx < 0 || nx >= columns || ny < 0 || ny >= rows) {
+                        continue;
+                    }
+                    if (core.getMark(nx, ny) != TileMark::Revealed) {
+                        continue;
+                    }
+                    int otherRemaining = hiddenNeighbours(nx, ny, otherHidden);
+                    progress = applySubsetRule(hidden, remaining, otherHidden, otherRemaining) ||
+                        applySubsetRule(otherHidden, otherRemaining, hidden, remaining);
+                }
+            }
+        }
+
+        if (!progress) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Function to generate a board, retrying seeds until one can be solved without guessing.
+// Gives up after maxAttempts, or as soon as *stopping is set, and returns the last
+// (still first click safe) layout with noGuess false.
+GeneratedBoard generateBoard(const ConfigValues& config, unsigned seed, int maxAttempts, int threadCount = 1, const atomic<bool>* stopping = nullptr) {
+    GeneratedBoard board;
+    board.columns = config.columns;
+    board.rows = config.rows;
+    board.mines = config.mines;
+
+    for (int attempt = 0; attempt < maxAttempts; ++attempt) {
+        board.seed = seed + static_cast<unsigned>(attempt);
+        placeGeneratedMines(board, threadCount);
+        countGeneratedMines(board, threadCount);
+        board.noGuess = isSolvableWithoutGuessing(board, stopping);
+        if (board.noGuess || (stopping && *stopping)) {
+            break;
+        }
+    }
+    return board;
+}
+
+// Thread pool that keeps a queue of ready boards for one configuration
+class BoardGenerator {
+public:
+    BoardGenerator(const ConfigValues& config, int workerCount, int bandThreads, size_t capacity);
+    ~BoardGenerator();
+    bool tryPop(GeneratedBoard& board);
+    static const int maxAttempts = 1000;
+
+private:
+    ConfigValues config;
+    int bandThreads; // threads each worker uses for placing and counting
+    BoundedQueue<GeneratedBoard> queue;
+    vector<thread> workers;
+    atomic<bool> stopping;
+    atomic<unsigned> nextSeed;
+
+    void workerLoop();
+};
+
+BoardGenerator::BoardGenerator(const ConfigValues& config, int workerCount, int bandThreads, size_t capacity)
+    : config(config), bandThreads(bandThreads), queue(capacity), stopping(false), nextSeed(random_device()()) {
+    for (int i = 0; i < workerCount; ++i) {
+        workers.emplace_back(&BoardGenerator::workerLoop, this);
+    }
+}
+
+BoardGenerator::~BoardGenerator() {
+    stopping = true;
+    for (thread& worker : workers) {
+        worker.join();
+    }
+}
+
+bool BoardGenerator::tryPop(GeneratedBoard& board) {
+    return queue.tryPop(board);
+}
+
+void BoardGenerator::workerLoop() {
+    while (!stopping) {
+        // Each worker claims a block of seeds so no two boards are the same
+        unsigned seed = nextSeed.fetch_add(maxAttempts);
+        GeneratedBoard board = generateBoard(config, seed, maxAttempts, bandThreads, &stopping);
+
+        // Only boards the solver cleared are queued, placeMines makes its own otherwise
+        if (!board.noGuess) {
+            continue;
+        }
+
+        // Wait for room in the queue
+        while (!queue.tryPush(board)) {
+            if (stopping) {
+                return;
+            }
+            this_thread::sleep_for(chrono::milliseconds(5));
+        }
+    }
+}
+
+// Result of playing many random games on a headless board
+struct SimulationResult {
+    int games;
+    int wins;
+    long long revealedTiles;
+};
+
+// Function to play games with random clicks until each one is won or lost
+template <typename SimulationBoard>
+SimulationResult simulateGames(SimulationBoard& board, int mines, int games, unsigned seed) {
+    SimulationResult result = { games, 0, 0 };
+    mt19937 rng(seed);
+    uniform_int_distribution<int> randomX(0, board.getColumns() - 1);
+    uniform_int_distribution<int> randomY(0, board.getRows() - 1);
+
+    for (int game = 0; game < games; ++game) {
+        board.placeRandomMines(seed + static_cast<unsigned>(game), mines);
+        while (!board.isWon()) {
+            int x = randomX(rng);
+            int y = randomY(rng);
+            int revealedTiles = board.reveal(x, y, nullptr);
+            if (revealedTiles < 0) {
+                break;
+            }
+            result.revealedTiles += revealedTiles;
+        }
+        if (board.isWon()) {
+            result.wins++;
+        }
+    }
+    return result;
+}
+
+// Function to run simulations on a fixed size board, called on the concrete type so the
+// compiler can inline the core rather than going through BoardCore's virtual calls
+template <int W, int H>
+SimulationResult simulateFixedGames(int mines, int games, unsigned seed) {
+    FixedBoard<W, H> board;
+    return simulateGames(board, mines, games, seed);
+}
+
+// Function to run simulations for a configuration on the core the game would use for it,
+// the same sizes as makeBoardCore
+SimulationResult runSimulations(const ConfigValues& config, int games, unsigned seed) {
+    if (config.columns == 9 && config.rows == 9) {
+        return simulateFixedGames<9, 9>(config.mines, games, seed);
+    }
+    if (config.columns == 16 && config.rows == 16) {
+        return simulateFixedGames<16, 16>(config.mines, games, seed);
+    }
+    if (config.columns == 30 && config.rows == 16) {
+        return simulateFixedGames<30, 16>(config.mines, games, seed);
+    }
+    if (config.columns == 25 && config.rows == 16) {
+        return simulateFixedGames<25, 16>(config.mines, games, seed);
+    }
+    DynamicBoard board(config.columns, config.rows);
+    return simulateGames(board, config.mines, games, seed);
+}
+
+// Saved state of a game in progress, one entry per tile in row-major order
+struct GameSnapshot {
+    int columns;
+    int rows;
+    int mines;
+    int flagsPlaced;
+    int revealedTiles;
+    bool gameWon;
+    bool gameLost;
+    bool isDebugMode;
+    vector<unsigned char> hasMine;
+    vector<unsigned char> tileStates; // TileMark values: 0 hidden, 1 revealed, 2 flagged
+};
+
+// Read-only view of a whole file mapped into memory
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+    bool open(const string& filename);
+    const unsigned char* data() const;
+    size_t size() const;
+
+private:
+    const unsigned char* view;
+    size_t length;
+#ifdef _WIN32
+    HANDLE file;
+    HANDLE mapping;
+#endif
+
+    MappedFile(const MappedFile&);
+    MappedFile& operator=(const MappedFile&);
+};
+
+#ifdef _WIN32
+MappedFile::MappedFile() : view(nullptr), length(0), file(INVALID_HANDLE_VALUE), mapping(nullptr) {
+}
+
+MappedFile::~MappedFile() {
+    if (view) {
+        UnmapViewOfFile(view);
+    }
+    if (mapping) {
+        CloseHandle(mapping);
+    }
+    if (file != INVALID_HANDLE_VALUE) {
+        CloseHandle(file);
+    }
+}
+
+bool MappedFile::open(const string& filename) {
+    file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+        return false;
+    }
+    length = static_cast<size_t>(fileSize.QuadPart);
+
+    mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        return false;
+    }
+    view = static_cast<const unsigned char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    return view != nullptr;
+}
+#else
+MappedFile::MappedFile() : view(nullptr), length(0) {
+}
+
+MappedFile::~MappedFile() {
+    if (view) {
+        munmap(const_cast<unsigned char*>(view), length);
+    }
+}
+
+bool MappedFile::open(const string& filename) {
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        close(fd);
+        return false;
+    }
+    length = static_cast<size_t>(info.st_size);
+
+    void* address = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // the mapping stays valid after the descriptor is closed
+    if (address == MAP_FAILED) {
+        return false;
+    }
+    view = static_cast<const unsigned char*>(address);
+    return true;
+}
+#endif
+
+const unsigned char* MappedFile::data() const {
+    return view;
+}
+
+size_t MappedFile::size() const {
+    return length;
+}
+
+// Snapshot file layout: magic, then eight little-endian 32-bit header fields (version,
+// columns, rows, mines, flagsPlaced, revealedTiles, game flags, reserved), the mine plane
+// at 1 bit per tile and the TileMark of every tile at 2 bits per tile (3 is not used)
+const char snapshotMagic[4] = { 'M', 'S', 'N', 'P' };
+const uint32_t snapshotVersion = 1;
+const size_t snapshotHeaderSize = sizeof(snapshotMagic) + 8 * sizeof(uint32_t);
+
+// Functions to store and load a 32-bit value little-endian, whatever the host byte order
+void writeLittleEndian32(unsigned char* out, uint32_t value) {
+    out[0] = static_cast<unsigned char>(value);
+    out[1] = static_cast<unsigned char>(value >> 8);
+    out[2] = static_cast<unsigned char>(value >> 16);
+    out[3] = static_cast<unsigned char>(value >> 24);
+}
+
+uint32_t readLittleEndian32(const unsigned char* in) {
+    return static_cast<uint32_t>(in[0]) | static_cast<uint32_t>(in[1]) << 8 |
+        static_cast<uint32_t>(in[2]) << 16 | static_cast<uint32_t>(in[3]) << 24;
+}
+
+// 2-bit codes for the tile states
+unsigned char encodeTileState(TileState state) {
+    switch (state) {
+    case TileState::Revealed:
+    case TileState::Number:
+        return 1;
+    case TileState::Flag:
+        return 2;
+    case TileState::Mine:
+        return 3;
+    default:
+        return 0;
+    }
+}
+
+TileState decodeTileState(unsigned char code) {
+    static const TileState states[4] = { TileState::Hidden, TileState::Revealed, TileState::Flag, TileState::Mine };
+    return states[code & 3];
+}
+
+// Lookup tables expanding one packed byte into its 8 mine or 4 state bytes
+struct SnapshotUnpackTables {
+    unsigned char mines[256][8];
+    unsigned char states[256][4];
+
+    SnapshotUnpackTables() {
+        for (int value = 0; value < 256; ++value) {
+            for (int bit = 0; bit < 8; ++bit) {
+                mines[value][bit] = (value >> bit) & 1;
+            }
+            for (int pair = 0; pair < 4; ++pair) {
+                states[value][pair] = (value >> (pair * 2)) & 3;
+            }
+        }
+    }
+};
+
+// Function to write a snapshot with a single buffered write
+bool writeSnapshotFile(const string& filename, const GameSnapshot& snapshot) {
+    const size_t tiles = static_cast<size_t>(snapshot.columns) * snapshot.rows;
+    const size_t minePlaneSize = (tiles + 7) / 8;
+    const size_t statePlaneSize = (tiles + 3) / 4;
+
+    vector<char> buffer(snapshotHeaderSize + minePlaneSize + statePlaneSize, 0);
+
+    uint32_t header[8] = {
+        snapshotVersion,
+        static_cast<uint32_t>(snapshot.columns),
+        static_cast<uint32_t>(snapshot.rows),
+        static_cast<uint32_t>(snapshot.mines),
+        static_cast<uint32_t>(snapshot.flagsPlaced),
+        static_cast<uint32_t>(snapshot.revealedTiles),
+        static_cast<uint32_t>((snapshot.gameWon ? 1 : 0) | (snapshot.gameLost ? 2 : 0) | (snapshot.isDebugMode ? 4 : 0)),
+        0
+    };
+    memcpy(buffer.data(), snapshotMagic, sizeof(snapshotMagic));
+    for (int i = 0; i < 8; ++i) {
+        writeLittleEndian32(reinterpret_cast<unsigned char*>(buffer.data()) + sizeof(snapshotMagic) + i * 4, header[i]);
+    }
+
+    unsigned char* minePlane = reinterpret_cast<unsigned char*>(buffer.data()) + snapshotHeaderSize;
+    unsigned char* statePlane = minePlane + minePlaneSize;
+    const unsigned char* mines = snapshot.hasMine.data();
+    const unsigned char* states = snapshot.tileStates.data();
+    // Whole bytes first, then the last partial byte of each plane
+    size_t i = 0;
+    for (; i + 8 <= tiles; i += 8) {
+        const unsigned char* m = mines + i;
+        const unsigned char* t = states + i;
+        minePlane[i >> 3] = static_cast<unsigned char>(m[0] | m[1] << 1 | m[2] << 2 | m[3] << 3 | m[4] << 4 | m[5] << 5 | m[6] << 6 | m[7] << 7);
+        statePlane[i >> 2] = static_cast<unsigned char>(t[0] | t[1] << 2 | t[2] << 4 | t[3] << 6);
+        statePlane[(i >> 2) + 1] = static_cast<unsigned char>(t[4] | t[5] << 2 | t[6] << 4 | t[7] << 6);
+    }
+    for (; i < tiles; ++i) {
+        minePlane[i >> 3] |= static_cast<unsigned char>((mines[i] & 1) << (i & 7));
+        statePlane[i >> 2] |= static_cast<unsigned char>((states[i] & 3) << ((i & 3) * 2));
+    }
+
+    ofstream file(filename, ios::binary | ios::trunc);
+    if (!file.is_open()) {
+        return false;
+    }
+    file.write(buffer.data(), static_cast<streamsize>(buffer.size()));
+    return file.good();
+}
+
+// Function to read a snapshot through a memory mapping, rejecting truncated or foreign files
+bool readSnapshotFile(const string& filename, GameSnapshot& snapshot) {
+    MappedFile file;
+    if (!file.open(filename) || file.size() < snapshotHeaderSize) {
+        return false;
+    }
+
+    const unsigned char* data = file.data();
+    if (memcmp(data, snapshotMagic, sizeof(snapshotMagic)) != 0) {
+        return false;
+    }
+
+    uint32_t header[8];
+    for (int i = 0; i < 8; ++i) {
+        header[i] = readLittleEndian32(data + sizeof(snapshotMagic) + i * 4);
+    }
+    if (header[0] != snapshotVersion || header[1] == 0 || header[2] == 0) {
+        return false;
+    }
+
+    const size_t tiles = static_cast<size_t>(header[1]) * header[2];
+    const size_t minePlaneSize = (tiles + 7) / 8;
+    const size_t statePlaneSize = (tiles + 3) / 4;
+    if (file.size() != snapshotHeaderSize + minePlaneSize + statePlaneSize) {
+        return false;
+    }
+
+    snapshot.columns = static_cast<int>(header[1]);
+    snapshot.rows = static_cast<int>(header[2]);
+    snapshot.mines = static_cast<int>(header[3]);
+    snapshot.flagsPlaced = static_cast<int>(header[4]);
+    snapshot.revealedTiles = static_cast<int>(header[5]);
+    snapshot.gameWon = (header[6] & 1) != 0;
+    snapshot.gameLost = (header[6] & 2) != 0;
+    snapshot.isDebugMode = (header[6] & 4) != 0;
+
+    const unsigned char* minePlane = data + snapshotHeaderSize;
+    const unsigned char* statePlane = minePlane + minePlaneSize;
+    snapshot.hasMine.resize(tiles);
+    snapshot.tileStates.resize(tiles);
+    unsigned char* mines = snapshot.hasMine.data();
+    unsigned char* states = snapshot.tileStates.data();
+    static const SnapshotUnpackTables tables;
+
+    size_t i = 0;
+    for (; i + 8 <= tiles; i += 8) {
+        memcpy(mines + i, tables.mines[minePlane[i >> 3]], 8);
+        memcpy(states + i, tables.states[statePlane[i >> 2]], 4);
+        memcpy(states + i + 4, tables.states[statePlane[(i >> 2) + 1]], 4);
+    }
+    for (; i < tiles; ++i) {
+        mines[i] = (minePlane[i >> 3] >> (i & 7)) & 1;
+        states[i] = (statePlane[i >> 2] >> ((i & 3) * 2)) & 3;
+    }
+    return true;
+}
+
+// Everything the render thread needs to draw one frame of the game
+struct RenderFrame {
+    int columns;
+    int rows;
+    vector<unsigned char> tiles; // row-major, encodeTileState code | number << 2
+    size_t changePosition; // how far into the Board's change log the tiles are up to date
+    int face; // 0 happy, 1 win, 2 lose
+    int remainingMines;
+    vector<chrono::steady_clock::time_point> inputTimes; // clicks this frame is the first to show
+};
+
+// Input to present latencies, only touched by the thread that presents frames
+class LatencyStats {
+public:
+    void record(chrono::steady_clock::time_point input, chrono::steady_clock::time_point presented);
+    double percentile(double p) const;
+    void report() const;
+
+private:
+    vector<double> samples; // milliseconds
+};
+
+void LatencyStats::record(chrono::steady_clock::time_point input, chrono::steady_clock::time_point presented) {
+    samples.push_back(chrono::duration<double, milli>(presented - input).count());
+}
+
+// Function to get a nearest-rank percentile (p between 0 and 100) of the recorded samples
+double LatencyStats::percentile(double p) const {
+    if (samples.empty()) {
+        return 0;
+    }
+    vector<double> sorted(samples);
+    size_t rank = static_cast<size_t>(p / 100.0 * (sorted.size() - 1) + 0.5);
+    nth_element(sorted.begin(), sorted.begin() + rank, sorted.end());
+    return sorted[rank];
+}
+
+void LatencyStats::report() const {
+    if (samples.empty()) {
         return;
     }
+    cout << "Input to present latency over " << samples.size() << " clicks: p50 " << percentile(50)
+        << " ms, p99 " << percentile(99) << " ms" << endl;
+}
+
+// Lock-free triple buffer for one writer and one reader. The writer fills back() and
+// publishes it, the reader always picks up the newest published slot and never waits.
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer();
+    T& back();
+    bool publish();
+    bool update();
+    const T& front() const;
+
+private:
+    static const int unreadFlag = 4;
+
+    array<T, 3> slots;
+    atomic<int> middle; // index of the middle slot, plus unreadFlag if it holds a new frame
+    int backIndex;
+    int frontIndex;
+};
+
+template <typename T>
+TripleBuffer<T>::TripleBuffer() : middle(1), backIndex(0), frontIndex(2) {
+}
+
+template <typename T>
+T& TripleBuffer<T>::back() {
+    return slots[backIndex];
+}
+
+// Writer: hand the back slot over and take the old middle slot to write into next.
+// Returns true if that slot was never read, so back() still holds the dropped frame.
+template <typename T>
+bool TripleBuffer<T>::publish() {
+    int previous = middle.exchange(backIndex | unreadFlag, memory_order_acq_rel);
+    backIndex = previous & 3;
+    return (previous & unreadFlag) != 0;
+}
+
+// Reader: swap in the newest frame, returns false if nothing new was published
+template <typename T>
+bool TripleBuffer<T>::update() {
+    if (!(middle.load(memory_order_relaxed) & unreadFlag)) {
+        return false;
+    }
+    frontIndex = middle.exchange(frontIndex, memory_order_acq_rel) & 3;
+    return true;
+}
+
+template <typename T>
+const T& TripleBuffer<T>::front() const {
+    return slots[frontIndex];
+}
+
+// Buttons in the panel under the board
+enum class UiWidget : unsigned char {
+    None,
+    Face,
+    Debug,
+    Test1,
+    Test2,
+    Test3
+};
+
+// Class representing the Minesweeper board
+class Board {
+public:
+    Board(const ConfigValues& config, int width, int height);
+    void draw(sf::RenderWindow& window);
+    void handleLeftClick(sf::Vector2i position);
+    void handleRightClick(sf::Vector2i position);
+    void printNumbers() const;
+    bool isGameOver() const;
+    bool isGameWon() const;
+    int getRemainingMines() const;
+    void reset();
+    bool saveSnapshot(const string& filename) const;
+    bool loadSnapshot(const string& filename);
+    void captureFrame(RenderFrame& frame) const;
+    bool isDebugMode;
+    void initializeBoardFromLayout(const vector<vector<bool>>& boardLayout);
+
+private:
+    int columns;
+    int rows;
+    int mines;
+    int originalMines;
+    int flagsPlaced;
+    int windowWidth;
+    int windowHeight;
+    bool gameWon;
+    bool gameLost;
+    int startX;
+    int startY;
+    unique_ptr<BoardGenerator> generator;
+    static const int generatorWaitMilliseconds = 100;
+
+    // Mines, counts and marks live in the core, the tiles only draw them
+    unique_ptr<BoardCore> core;
+    vector<Tile> grid; // row-major (y * columns + x), the same layout as the core's planes
+
+    // Log of the tiles whose picture changed, so captureFrame only copies those into a frame.
+    // Positions count every change ever logged, changedTiles holds them from changeLogStart on.
+    vector<int> changedTiles;
+    size_t changeLogStart;
+    vector<sf::Texture> digitTextures;
+
+    TileTextures tileTextures;
+    PanelTextures panelTextures;
+    sf::Sprite faceSprite;
+    sf::Sprite buttonSprites[4]; // debug, test 1, test 2, test 3
+
+    // Hit-test table for the panel: the widget under each pixel column, and each widget's bounds
+    vector<UiWidget> widgetColumns;
+    sf::FloatRect widgetBounds[6];
+
+    void initializeDebugButton();
+    void drawDebugButton(sf::RenderWindow& window);
+    void handleDebugButtonClick(sf::Vector2i position);
+    void initializeBoard();
+    void placeMines();
+    void revealStartingArea();
+    void checkForWin();
+    void clearGame();
+    void revealEmptyTiles(int x, int y);
+    TileState getTilePicture(bool mine, TileMark mark) const;
+    void updateTile(int x, int y);
+    void updateAllTiles();
+    void markTileChanged(int index);
+    void markAllTilesChanged();
+    void initializeFaceTextures();
+    void updateFaceTexture();
+    void buildHitTestTable();
+    UiWidget hitTestWidget(sf::Vector2i position) const;
+    void loadTestBoard(int number);
+};
+
+// Constructor for the Board class
+Board::Board(const ConfigValues& config, int width, int height)
+    : columns(config.columns), rows(config.rows), mines(config.mines), originalMines(config.mines), flagsPlaced(0), gameWon(false), gameLost(false), windowWidth(width), windowHeight(height), isDebugMode(false), startX(0), startY(0), changeLogStart(0) {
+
+    grid.resize(static_cast<size_t>(columns) * rows);
+
+    // Start generating boards in the background, leaving a core for the game. Boards with
+    // more than one band spread each board over the threads, small ones run a board per thread.
+    int generatorThreads = max(1, static_cast<int>(thread::hardware_concurrency()) / 2);
+    int bandThreads = rows > generationBandRows ? generatorThreads : 1;
+    generator.reset(new BoardGenerator(config, generatorThreads / bandThreads, bandThreads, 8));
+
+    // Start with an empty board, the first game comes from reset() or loadSnapshot()
+    core = makeBoardCore(config);
+    initializeBoard();
+
+    // Load digit textures
+    sf::Texture digitTexture;
+    digitTexture.loadFromFile("images/digits.png");  
+
+    // Split the digit texture into separate textures for each digit
+    int digitWidth = digitTexture.getSize().x / 10;  
+    int digitHeight = digitTexture.getSize().y;
+    digitTextures.resize(10);
+
+    for (int i = 0; i < 10; ++i) {
+        digitTextures[i].loadFromImage(digitTexture.copyToImage(), sf::IntRect(i * digitWidth, 0, digitWidth, digitHeight));
+    }
+
+    // Tile and panel textures are loaded once for the whole board
+    tileTextures.load();
+    panelTextures.load();
+
+    initializeFaceTextures();
+    initializeDebugButton();
+    updateFaceTexture();
+}
+
+void Board::initializeDebugButton() {
+    //debug and test buttons, placed by layoutPanel in updateFaceTexture
+    for (int i = 0; i < 4; ++i) {
+        buttonSprites[i].setTexture(panelTextures.buttons[i]);
+    }
+}
+
+void Board::drawDebugButton(sf::RenderWindow& window) {
+    //debug and test buttons
+    for (int i = 0; i < 4; ++i) {
+        window.draw(buttonSprites[i]);
+    }
+}
+
+void Board::initializeFaceTextures() {
+    faceSprite.setTexture(panelTextures.faces[0]);
+}
+
+void Board::updateFaceTexture() {
+    if (gameWon) {
+        faceSprite.setTexture(panelTextures.faces[1]);
+    }
+    else if (gameLost) {
+        faceSprite.setTexture(panelTextures.faces[2]);
+    }
+    else {
+        faceSprite.setTexture(panelTextures.faces[0]);
+    }
+
+    // Place the face and the buttons at the bottom of the window
+    layoutPanel(faceSprite, buttonSprites, windowWidth, windowHeight);
+
+    // The face may have moved, so the hit-test table has to follow it
+    buildHitTestTable();
+}
+
+// Function to precompute which widget sits under each pixel column of the panel
+void Board::buildHitTestTable() {
+    widgetBounds[static_cast<int>(UiWidget::None)] = sf::FloatRect();
+    widgetBounds[static_cast<int>(UiWidget::Face)] = faceSprite.getGlobalBounds();
+    widgetBounds[static_cast<int>(UiWidget::Debug)] = buttonSprites[0].getGlobalBounds();
+    widgetBounds[static_cast<int>(UiWidget::Test1)] = buttonSprites[1].getGlobalBounds();
+    widgetBounds[static_cast<int>(UiWidget::Test2)] = buttonSprites[2].getGlobalBounds();
+    widgetBounds[static_cast<int>(UiWidget::Test3)] = buttonSprites[3].getGlobalBounds();
+
+    widgetColumns.assign(windowWidth, UiWidget::None);
+
+    // Fill in reverse so the face wins where widgets overlap, the same order handleLeftClick used to check them
+    for (int widget = 5; widget >= 1; --widget) {
+        const sf::FloatRect& bounds = widgetBounds[widget];
+        int left = max(0, static_cast<int>(bounds.left));
+        int right = min(windowWidth, static_cast<int>(bounds.left + bounds.width + 1));
+        for (int x = left; x < right; ++x) {
+            if (bounds.contains(static_cast<float>(x), bounds.top)) {
+                widgetColumns[x] = static_cast<UiWidget>(widget);
+            }
+        }
+    }
+}
+
+// Function to find the widget under a position, one table lookup and one bounds check
+UiWidget Board::hitTestWidget(sf::Vector2i position) const {
+    if (position.x < 0 || position.x >= windowWidth) {
+        return UiWidget::None;
+    }
+    UiWidget widget = widgetColumns[position.x];
+    if (widget != UiWidget::None && widgetBounds[static_cast<int>(widget)].contains(static_cast<float>(position.x), static_cast<float>(position.y))) {
+        return widget;
+    }
+    return UiWidget::None;
+}
+
+void Board::draw(sf::RenderWindow& window) {
+    // Draw the board
+    for (int y = 0; y < rows; ++y) {
+        for (int x = 0; x < columns; ++x) {
+            grid[y * columns + x].draw(window, tileTextures, x, y);
+        }
+    }
+
+    // Draw the happy face
+    window.draw(faceSprite);
+
+    // Draw the debug button
+    drawDebugButton(window);
+}
+
+// initialize the Minesweeper board
+void Board::initializeBoard() {
+    // Set all tiles to Hidden initially
+    for (int y = 0; y < rows; ++y) {
+        for (int x = 0; x < columns; ++x) {
+            grid[y * columns + x].setState(TileState::Hidden);
+        }
+    }
+    markAllTilesChanged();
+}
+
+// initializes the board that was loaded from one of the files
+void Board::initializeBoardFromLayout(const vector<vector<bool>>& boardLayout) {
+    // Set all tiles to Hidden initially
+    for (int y = 0; y < rows; ++y) {
+        for (int x = 0; x < columns; ++x) {
+            grid[y * columns + x].setState(TileState::Hidden);
+        }
+    }
+    markAllTilesChanged();
+
+    // Set mine and non-mine tiles based on the layout
+    vector<unsigned char> hasMine(static_cast<size_t>(columns) * rows, 0);
+
+    for (int y = 0; y < rows; ++y) {
+        for (int x = 0; x < columns; ++x) {
+            if (boardLayout[y][x]) {
+                // Set as mine
+                hasMine[y * columns + x] = 1;
+            }
+        }
+    }
+
+    // The core counts the neighbours itself when no counts are passed in
+    core->setMines(hasMine.data(), nullptr);
+    mines = core->getMines(); // Update the total number of mines
+}
+
+// Function to place mines on the board, taking a ready board from the generator
+void Board::placeMines() {
+    // Give the generator a moment if nothing is ready, e.g. right after startup
+    GeneratedBoard board;
+    bool ready = generator->tryPop(board);
+    for (int waited = 0; !ready && waited < generatorWaitMilliseconds; ++waited) {
+        this_thread::sleep_for(chrono::milliseconds(1));
+        ready = generator->tryPop(board);
+    }
+
+    if (!ready) {
+        // Still nothing, place one here without running the solver. The board is first
+        // click safe but may need a guess.
+        int threads = static_cast<int>(thread::hardware_concurrency());
+        board.columns = columns;
+        board.rows = rows;
+        board.mines = mines;
+        board.seed = random_device()();
+        board.noGuess = false;
+        placeGeneratedMines(board, threads);
+        countGeneratedMines(board, threads);
+    }
+
+    // The generator's planes are already in the core's layout, including the counts
+    core->setMines(board.hasMine.data(), board.counts.data());
+    mines = core->getMines(); // fewer than asked for if the board was too full
+
+    startX = board.startX;
+    startY = board.startY;
+}
+
+// Function to open the generated safe area so the game never starts with a guess
+void Board::revealStartingArea() {
+    revealEmptyTiles(startX, startY);
+    checkForWin();
+}
+
+// Function to end the game as won once every tile without a mine is revealed. Flagged
+// tiles without a mine count as revealed, as they always have.
+void Board::checkForWin() {
+    if (core->getRevealedTiles() + core->getFlaggedSafeTiles() == columns * rows - core->getMines()) {
+        gameWon = true;
+        // Show every mine as a flag
+        updateAllTiles();
+        updateFaceTexture();
+    }
+}
+
+// Function to print out the numbers for each tile, for debugging purposes
+void Board::printNumbers() const {
+    for (int y = 0; y < rows; ++y) {
+        for (int x = 0; x < columns; ++x) {
+            cout << core->getCount(x, y) << " ";
+        }
+        cout << endl;
+    }
+}
+
+int Board::getRemainingMines() const {
+    // Calculate remaining mines by subtracting flagsPlaced from the total mines
+    return mines - flagsPlaced;
+}
+
+bool Board::isGameOver() const {
+    return gameLost;
+}
+
+bool Board::isGameWon() const {
+    return gameWon;
+}
+
+// Function to reveal a tile, flood filling empty tiles, and show what was revealed
+void Board::revealEmptyTiles(int x, int y) {
+    vector<int> revealed;
+    core->reveal(x, y, &revealed);
+    for (int index : revealed) {
+        updateTile(index % columns, index / columns);
+    }
+}
 
-    sf::FloatRect test2ButtonBounds = test2ButtonSprite.getGlobalBounds();
-    if (test2ButtonBounds.contains(static_cast<float>(position.x), static_cast<float>(position.y))) {
-        // Load and initialize the second test board (testboard2.brd)
-        vector<vector<bool>> boardLayout;
-        if (readBoardFile("boards/testboard2.brd", boardLayout)) {
-            reset();
-            initializeBoardFromLayout(boardLayout);
+// Function to pick a tile's picture from its mine and mark and the state of the game
+TileState Board::getTilePicture(bool mine, TileMark mark) const {
+    if (mine && gameWon) {
+        return TileState::Flag;
+    }
+    if (mine && (gameLost || isDebugMode)) {
+        return TileState::Mine;
+    }
+    if (mark == TileMark::Revealed) {
+        return TileState::Revealed;
+    }
+    return mark == TileMark::Flagged ? TileState::Flag : TileState::Hidden;
+}
+
+// Function to set a tile's picture from the core and the state of the game
+void Board::updateTile(int x, int y) {
+    TileState state = getTilePicture(core->hasMine(x, y), core->getMark(x, y));
+    grid[y * columns + x].setState(state, state == TileState::Revealed ? core->getCount(x, y) : 0);
+    markTileChanged(y * columns + x);
+}
 
+// Function to redraw every tile, after the game ends, debug mode changes or a game is
+// restored. Reads the core's planes a band of rows at a time rather than tile by tile.
+void Board::updateAllTiles() {
+    // The picture only depends on the mine and the mark while the game state holds still
+    TileState pictures[2][3];
+    for (int mine = 0; mine < 2; ++mine) {
+        for (int mark = 0; mark < 3; ++mark) {
+            pictures[mine][mark] = getTilePicture(mine != 0, static_cast<TileMark>(mark));
         }
-        else {
-            cerr << "Failed to load Test Board 2." << endl;
+    }
+
+    const int bandRows = 64;
+    vector<unsigned char> mineData(static_cast<size_t>(columns) * bandRows);
+    vector<unsigned char> countData(mineData.size());
+    vector<unsigned char> markData(mineData.size());
+
+    for (int y0 = 0; y0 < rows; y0 += bandRows) {
+        int bandCount = min(bandRows, rows - y0);
+        core->getPlanes(y0, bandCount, mineData.data(), countData.data(), markData.data());
+
+        Tile* tiles = &grid[static_cast<size_t>(y0) * columns];
+        for (size_t i = 0; i < static_cast<size_t>(columns) * bandCount; ++i) {
+            TileState state = pictures[mineData[i]][markData[i]];
+            tiles[i].setState(state, state == TileState::Revealed ? countData[i] : 0);
         }
+    }
+    markAllTilesChanged();
+}
+
+// Function to log a tile for the next frames. Once the log gets long, copying the whole
+// board is about as cheap as replaying it, so it is dropped instead.
+void Board::markTileChanged(int index) {
+    if (changedTiles.size() >= grid.size() / 4) {
+        markAllTilesChanged();
         return;
     }
+    changedTiles.push_back(index);
+}
+
+// Function to drop the change log, every frame captured before now gets a full copy. The
+// gap of one position keeps frames captured at the old end of the log from matching.
+void Board::markAllTilesChanged() {
+    changeLogStart += changedTiles.size() + 1;
+    changedTiles.clear();
+}
+
+// Function to load and initialize one of the test boards (boards/testboardN.brd)
+void Board::loadTestBoard(int number) {
+    vector<vector<bool>> boardLayout;
+    if (readBoardFile("boards/testboard" + to_string(number) + ".brd", boardLayout)) {
+        clearGame();
+        initializeBoardFromLayout(boardLayout);
+    }
+    else {
+        cerr << "Failed to load Test Board " << number << "." << endl;
+    }
+}
 
-    sf::FloatRect test3ButtonBounds = test3ButtonSprite.getGlobalBounds();
-    if (test3ButtonBounds.contains(static_cast<float>(position.x), static_cast<float>(position.y))) {
-        // Load and initialize the third test board (testboard3.brd)
-        vector<vector<bool>> boardLayout;
-        if (readBoardFile("boards/testboard3.brd", boardLayout)) {
+// Function to handle left-click events on the Minesweeper board
+void Board::handleLeftClick(sf::Vector2i position) {
+    // Clicks on the grid never reach the panel widgets
+    if (position.y < 0 || position.y >= rows * 32) {
+        switch (hitTestWidget(position)) {
+        case UiWidget::Face:
             reset();
-            initializeBoardFromLayout(boardLayout);
+            isDebugMode = false;
+            return;
 
+        case UiWidget::Debug:
+            if (gameWon || gameLost) {
+                return;
+            }
+            // Toggle debug mode
+            isDebugMode = !isDebugMode;
+
+            // Show or hide the mines, flags come back when debug mode is turned off
+            updateAllTiles();
+            return;
+
+        case UiWidget::Test1:
+            loadTestBoard(1);
+            return;
+
+        case UiWidget::Test2:
+            loadTestBoard(2);
+            return;
+
+        case UiWidget::Test3:
+            loadTestBoard(3);
+            return;
+
+        default:
+            break;
         }
-        else {
-            cerr << "Failed to load Test Board 3." << endl;
-        }
-        return;
     }
 
     int x = position.x / 32;
@@ -594,45 +2027,23 @@ void Board::handleLeftClick(sf::Vector2i position) {
         if (gameWon || gameLost) {
             return;
         }
-        Tile& clickedTile = grid[x][y];
+        // Mines shown in debug mode can't be clicked
+        if (isDebugMode && core->hasMine(x, y)) {
+            return;
+        }
 
-        if (clickedTile.getState() == TileState::Hidden) {
-            if (hasMine[x][y]) {
-                // Reveal the mine
-                clickedTile.setState(TileState::Mine);
-                revealAllMinesFlags(1); // Reveal all mines on the board
+        if (core->getMark(x, y) == TileMark::Hidden) {
+            if (core->hasMine(x, y)) {
+                // Reveal all mines on the board
                 gameLost = true;
+                updateAllTiles();
                 updateFaceTexture();
-
             }
             else {
-                if (getMineCount(x, y) == 0) {
-                    // reveals tiles which are not adjacent to mines
-                    revealEmptyTiles(x, y);
-                }
-                else {
-                    // reveals the number
-                    int number = adjacentMineCounts[x][y];
-                    clickedTile.setState(TileState::Revealed, number);
-                }
+                // Reveals the number, or the whole empty area around it
+                revealEmptyTiles(x, y);
                 // Check for winning condition
-                int revealedTiles = 0;
-                for (int i = 0; i < columns; ++i) {
-                    for (int j = 0; j < rows; ++j) {
-                        TileState state = grid[i][j].getState();
-
-                        // Check if the game is won when all non-mine tiles are revealed
-                        if (!hasMine[i][j] && (state == TileState::Revealed || state == TileState::Flag)) {
-                            revealedTiles++;
-                        }
-                    }
-                }
-                if (revealedTiles == (columns * rows - mines)) {
-                    gameWon = true;
-                    //reveals flags because 0 is for flags and 1 is for mines
-                    revealAllMinesFlags(0);
-                    updateFaceTexture();
-                }
+                checkForWin();
             }
         }
     }
@@ -648,38 +2059,38 @@ void Board::handleRightClick(sf::Vector2i position) {
     int y = position.y / 32;
 
     if (x >= 0 && x < columns && y >= 0 && y < rows) {
-        Tile& clickedTile = grid[x][y];
+        // Mines shown in debug mode can't be flagged
+        if (isDebugMode && core->hasMine(x, y)) {
+            return;
+        }
 
         // Toggle between Flag and Hidden states on right-click
-        if (clickedTile.getState() == TileState::Hidden) {
+        if (core->getMark(x, y) == TileMark::Hidden) {
             // Toggle to Flag state
-            clickedTile.setState(TileState::Flag);
+            core->setMark(x, y, TileMark::Flagged);
             flagsPlaced++;
         }
-        else if (clickedTile.getState() == TileState::Flag) {
+        else if (core->getMark(x, y) == TileMark::Flagged) {
             // Toggle back to Hidden state
-            clickedTile.setState(TileState::Hidden);
+            core->setMark(x, y, TileMark::Hidden);
             flagsPlaced--;
         }
+        updateTile(x, y);
     }
 }
 
-//function to reveal all flags or mines depending on conditions
-void Board::revealAllMinesFlags(int a) {
-    for (int x = 0; x < columns; ++x) {
-        for (int y = 0; y < rows; ++y) {
-            if (hasMine[x][y] && a == 1) {
-                // If a tile contains a mine, set its state to Revealed
-                grid[x][y].setState(TileState::Mine);
-            }
-            else if (hasMine[x][y] && a == 0) {
-                grid[x][y].setState(TileState::Flag);
-            }
-        }
-    }
+void Board::reset() {
+    clearGame();
+
+    placeMines();
+    revealStartingArea();
+
+    // Reset face texture
+    updateFaceTexture();
 }
 
-void Board::reset() {
+// Function to reset the counters and hide every tile, leaving the board without mines
+void Board::clearGame() {
     // Reset game state
     flagsPlaced = 0;
     gameWon = false;
@@ -690,22 +2101,501 @@ void Board::reset() {
 
     // Clear existing data
     grid.clear();
-    hasMine.clear();
-    adjacentMineCounts.clear();
 
     // Resize and reinitialize the grid
-    grid.resize(columns, vector<Tile>(rows));
-    hasMine.resize(columns, vector<bool>(rows, false));
+    grid.resize(static_cast<size_t>(columns) * rows);
+    core->setMines(nullptr, nullptr);
 
     initializeBoard();
-    placeMines();
-    countAdjacentMines();
+    updateFaceTexture();
+}
+
+// Function to save the current game to a snapshot file
+bool Board::saveSnapshot(const string& filename) const {
+    GameSnapshot snapshot;
+    snapshot.columns = columns;
+    snapshot.rows = rows;
+    snapshot.mines = mines;
+    snapshot.flagsPlaced = flagsPlaced;
+    snapshot.revealedTiles = core->getRevealedTiles();
+    snapshot.gameWon = gameWon;
+    snapshot.gameLost = gameLost;
+    snapshot.isDebugMode = isDebugMode;
+    snapshot.hasMine.resize(static_cast<size_t>(columns) * rows);
+    snapshot.tileStates.resize(static_cast<size_t>(columns) * rows);
+
+    // The marks are saved rather than the pictures, so flags under debug mode survive
+    core->getPlanes(0, rows, snapshot.hasMine.data(), nullptr, snapshot.tileStates.data());
+
+    return writeSnapshotFile(filename, snapshot);
+}
+
+// Function to restore a game saved by saveSnapshot, the board size must match
+bool Board::loadSnapshot(const string& filename) {
+    GameSnapshot snapshot;
+    if (!readSnapshotFile(filename, snapshot) || snapshot.columns != columns || snapshot.rows != rows) {
+        return false;
+    }
+
+    // Make sure the header agrees with the planes before touching the board
+    int revealedCount = 0;
+    int flaggedCount = 0;
+    int unusedCount = 0;
+    int mineCount = 0;
+    const unsigned char* codes = snapshot.tileStates.data();
+    const unsigned char* mineFlags = snapshot.hasMine.data();
+    for (size_t i = 0; i < snapshot.tileStates.size(); ++i) {
+        revealedCount += codes[i] == 1;
+        flaggedCount += codes[i] == 2;
+        unusedCount += codes[i] == 3;
+        mineCount += mineFlags[i];
+    }
+    if (revealedCount != snapshot.revealedTiles || flaggedCount != snapshot.flagsPlaced || unusedCount != 0 ||
+        mineCount != snapshot.mines) {
+        return false;
+    }
+
+    mines = snapshot.mines;
+    flagsPlaced = snapshot.flagsPlaced;
+    gameWon = snapshot.gameWon;
+    gameLost = snapshot.gameLost;
+    isDebugMode = snapshot.isDebugMode;
+
+    core->setMines(snapshot.hasMine.data(), nullptr);
+    core->setMarks(snapshot.tileStates.data());
+    updateAllTiles();
 
-    // Reset face texture
     updateFaceTexture();
+    return true;
+}
+
+// Function to bring a frame for the render thread up to date with what is on screen. Only
+// the tiles logged since the frame was last captured are copied, when the log still has them.
+void Board::captureFrame(RenderFrame& frame) const {
+    frame.columns = columns;
+    frame.rows = rows;
+    frame.face = gameWon ? 1 : (gameLost ? 2 : 0);
+    frame.remainingMines = getRemainingMines();
+
+    if (frame.tiles.size() != grid.size() || frame.changePosition < changeLogStart) {
+        frame.tiles.resize(grid.size());
+        for (size_t index = 0; index < grid.size(); ++index) {
+            const Tile& tile = grid[index];
+            frame.tiles[index] = static_cast<unsigned char>(encodeTileState(tile.getState()) | tile.getNumber() << 2);
+        }
+    }
+    else {
+        for (size_t i = frame.changePosition - changeLogStart; i < changedTiles.size(); ++i) {
+            const Tile& tile = grid[changedTiles[i]];
+            frame.tiles[changedTiles[i]] = static_cast<unsigned char>(encodeTileState(tile.getState()) | tile.getNumber() << 2);
+        }
+    }
+    frame.changePosition = changeLogStart + changedTiles.size();
+}
+
+// Function to draw the remaining mines counter in the bottom left corner
+void drawMineCounter(sf::RenderWindow& window, sf::Sprite& digitSprite, int remainingMines, int windowHeight) {
+    // Digit size in images/digits.png
+    const int digitWidth = 21;
+    const int digitHeight = 32;
+
+    string minesString = to_string(abs(remainingMines));
+
+    // Center the counter between board and bottom of the window
+    int offsetX = 10;
+    int offsetY = static_cast<int>((windowHeight - digitHeight * 2));
+
+    // Draw the negative sign if the number is negative
+    if (remainingMines < 0) {
+        digitSprite.setTextureRect(sf::IntRect(10 * digitWidth, 0, digitWidth, digitHeight));
+        digitSprite.setPosition(static_cast<float>(offsetX), static_cast<float>(offsetY));
+        window.draw(digitSprite);
+        offsetX += digitWidth;
+    }
+
+    for (size_t i = 0; i < minesString.size(); ++i) {
+        int digitValue = minesString[i] - '0';
+        digitSprite.setTextureRect(sf::IntRect(digitValue * digitWidth, 0, digitWidth, digitHeight));
+
+        digitSprite.setPosition(static_cast<float>(offsetX + i * digitWidth), static_cast<float>(offsetY));
+        window.draw(digitSprite);
+    }
+}
+
+// Class that draws RenderFrames on the render thread, with its own copy of the textures
+class BoardRenderer {
+public:
+    BoardRenderer(int width, int height);
+    void draw(sf::RenderWindow& window, const RenderFrame& frame);
+
+private:
+    int windowWidth;
+    int windowHeight;
+
+    TileTextures tileTextures;
+    PanelTextures panelTextures;
+    sf::Texture digitTexture;
+
+    sf::Sprite tileSprite;
+    sf::Sprite faceSprite;
+    sf::Sprite buttonSprites[4];
+    sf::Sprite digitSprite;
+};
+
+BoardRenderer::BoardRenderer(int width, int height) : windowWidth(width), windowHeight(height) {
+    tileTextures.load();
+    panelTextures.load();
+
+    faceSprite.setTexture(panelTextures.faces[0]);
+    for (int i = 0; i < 4; ++i) {
+        buttonSprites[i].setTexture(panelTextures.buttons[i]);
+    }
+    layoutPanel(faceSprite, buttonSprites, windowWidth, windowHeight);
+
+    digitTexture.loadFromFile("images/digits.png");
+    digitSprite.setTexture(digitTexture);
+}
+
+void BoardRenderer::draw(sf::RenderWindow& window, const RenderFrame& frame) {
+    window.clear(sf::Color::White);
+
+    for (int y = 0; y < frame.rows; ++y) {
+        for (int x = 0; x < frame.columns; ++x) {
+            unsigned char tile = frame.tiles[y * frame.columns + x];
+            drawTile(window, tileTextures, tileSprite, decodeTileState(tile & 3), tile >> 2, x, y);
+        }
+    }
+
+    faceSprite.setTexture(panelTextures.faces[frame.face]);
+    layoutPanel(faceSprite, buttonSprites, windowWidth, windowHeight);
+    window.draw(faceSprite);
+
+    for (int i = 0; i < 4; ++i) {
+        window.draw(buttonSprites[i]);
+    }
+
+    drawMineCounter(window, digitSprite, frame.remainingMines, windowHeight);
+
+    window.display();
+}
+
+// Function run by the render thread, drawing the newest published frame until stopped
+void renderLoop(sf::RenderWindow& window, TripleBuffer<RenderFrame>& frames, const atomic<bool>& running, LatencyStats& latency, int windowWidth, int windowHeight) {
+    window.setActive(true);
+    BoardRenderer renderer(windowWidth, windowHeight);
+
+    while (running) {
+        bool newFrame = frames.update();
+        // The frame rate limit makes display() wait, so this does not spin
+        renderer.draw(window, frames.front());
+
+        if (newFrame) {
+            chrono::steady_clock::time_point presented = chrono::steady_clock::now();
+            for (chrono::steady_clock::time_point input : frames.front().inputTimes) {
+                latency.record(input, presented);
+            }
+        }
+    }
+
+    window.setActive(false);
+}
+
+// Function to check for the clicks the board reacts to, only these are timed and redrawn
+bool isBoardClick(const sf::Event& event) {
+    return event.type == sf::Event::MouseButtonPressed &&
+        (event.mouseButton.button == sf::Mouse::Left || event.mouseButton.button == sf::Mouse::Right);
+}
+
+// Function to pass a mouse click on to the board, at the position stored in the event
+void handleMouseClick(Board& minesweeper, const sf::Event& event) {
+    sf::Vector2i position(event.mouseButton.x, event.mouseButton.y);
+    if (event.mouseButton.button == sf::Mouse::Left) {
+        minesweeper.handleLeftClick(position);
+    }
+    else if (event.mouseButton.button == sf::Mouse::Right) {
+        minesweeper.handleRightClick(position);
+    }
+}
+
+// Function to keep unfinished games when the window closes, finished ones start fresh next time
+void saveGameOnClose(const Board& minesweeper, const string& snapshotFile) {
+    if (minesweeper.isGameOver() || minesweeper.isGameWon()) {
+        remove(snapshotFile.c_str());
+    }
+    else if (!minesweeper.saveSnapshot(snapshotFile)) {
+        cerr << "Failed to save the game." << endl;
+    }
+}
+
+// Function to time mine placement and counting on a large board for 1, 2, 4, ... threads.
+// Every run must produce exactly the same board as the single threaded one.
+int runGenerationBenchmark(int columns, int rows, int mines) {
+    const unsigned seed = 12345;
+    int maxThreads = max(1, static_cast<int>(thread::hardware_concurrency()));
+
+    vector<int> threadCounts;
+    for (int threads = 1; threads < maxThreads; threads *= 2) {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(maxThreads);
+
+    cout << "Generating " << columns << "x" << rows << " with " << mines << " mines" << endl;
+    cout << "threads\tplace ms\tcount ms\ttotal ms\tspeedup\tidentical" << endl;
+
+    GeneratedBoard reference;
+    double referenceTime = 0;
+    bool allIdentical = true;
+
+    for (int threads : threadCounts) {
+        GeneratedBoard board;
+        board.columns = columns;
+        board.rows = rows;
+        board.mines = mines;
+        board.seed = seed;
+
+        auto start = chrono::steady_clock::now();
+        placeGeneratedMines(board, threads);
+        auto placed = chrono::steady_clock::now();
+        countGeneratedMines(board, threads);
+        auto counted = chrono::steady_clock::now();
+
+        double placeTime = chrono::duration<double, milli>(placed - start).count();
+        double countTime = chrono::duration<double, milli>(counted - placed).count();
+        double totalTime = placeTime + countTime;
+
+        if (threads == 1) {
+            referenceTime = totalTime;
+            reference = std::move(board);
+            cout << threads << "\t" << placeTime << "\t" << countTime << "\t" << totalTime << "\t1\tyes" << endl;
+            continue;
+        }
+
+        bool identical = board.hasMine == reference.hasMine && board.counts == reference.counts;
+        allIdentical = allIdentical && identical;
+        cout << threads << "\t" << placeTime << "\t" << countTime << "\t" << totalTime << "\t"
+            << referenceTime / totalTime << "\t" << (identical ? "yes" : "NO") << endl;
+    }
+
+    return allIdentical ? 0 : 1;
+}
+
+// Board's reveal logic from before BoardCore, kept as the baseline for --bench-simulation:
+// column-major vector<vector<>> planes, bounds-checked neighbour counts and a recursive
+// flood fill that counts again for every tile. Tile pictures are left out, states are
+// tracked on their own. Mines are placed with the same shuffle as GridBoard.
+class LegacyBoard {
+public:
+    LegacyBoard(int columns, int rows);
+    int getColumns() const { return columns; }
+    int getRows() const { return rows; }
+    void placeRandomMines(unsigned seed, int mineCount);
+    int reveal(int x, int y, vector<int>* revealed);
+    bool isWon() const { return revealedTiles == columns * rows - mines; }
+
+private:
+    int columns;
+    int rows;
+    int mines;
+    int revealedTiles;
+    vector<vector<bool>> hasMine;
+    vector<vector<int>> adjacentMineCounts;
+    vector<vector<TileState>> states;
+
+    int getMineCount(int x, int y) const;
+    void revealEmptyTiles(int x, int y);
+};
+
+LegacyBoard::LegacyBoard(int columns, int rows) : columns(columns), rows(rows), mines(0), revealedTiles(0) {
+}
+
+void LegacyBoard::placeRandomMines(unsigned seed, int mineCount) {
+    const int size = columns * rows;
+    hasMine.assign(columns, vector<bool>(rows, false));
+    adjacentMineCounts.assign(columns, vector<int>(rows, 0));
+    states.assign(columns, vector<TileState>(rows, TileState::Hidden));
+
+    mt19937 rng(seed);
+    vector<int> shuffle(size);
+    for (int i = 0; i < size; ++i) {
+        shuffle[i] = i;
+    }
+    mines = min(mineCount, size);
+    for (int i = 0; i < mines; ++i) {
+        int j = uniform_int_distribution<int>(i, size - 1)(rng);
+        swap(shuffle[i], shuffle[j]);
+        hasMine[shuffle[i] % columns][shuffle[i] / columns] = true;
+    }
+
+    for (int x = 0; x < columns; ++x) {
+        for (int y = 0; y < rows; ++y) {
+            if (!hasMine[x][y]) {
+                adjacentMineCounts[x][y] = getMineCount(x, y);
+            }
+        }
+    }
+    revealedTiles = 0;
+}
+
+int LegacyBoard::getMineCount(int x, int y) const {
+    int count = 0;
+    for (int dx = -1; dx <= 1; ++dx) {
+        for (int dy = -1; dy <= 1; ++dy) {
+            int nx = x + dx;
+            int ny = y + dy;
+            if (nx >= 0 && nx < columns && ny >= 0 && ny < rows && hasMine[nx][ny]) {
+                count++;
+            }
+        }
+    }
+    return count;
+}
+
+void LegacyBoard::revealEmptyTiles(int x, int y) {
+    if (x < 0 || x >= columns || y < 0 || y >= rows || states[x][y] != TileState::Hidden) {
+        return;
+    }
+    states[x][y] = TileState::Revealed;
+    revealedTiles++;
+    if (getMineCount(x, y) == 0) {
+        for (int dx = -1; dx <= 1; ++dx) {
+            for (int dy = -1; dy <= 1; ++dy) {
+                int nx = x + dx;
+                int ny = y + dy;
+                if (nx >= 0 && nx < columns && ny >= 0 && ny < rows && !hasMine[nx][ny]) {
+                    revealEmptyTiles(nx, ny);
+                }
+            }
+        }
+    }
+}
+
+// Function to reveal a tile the way handleLeftClick used to, the revealed list is not filled
+int LegacyBoard::reveal(int x, int y, vector<int>*) {
+    if (states[x][y] != TileState::Hidden) {
+        return 0;
+    }
+    if (hasMine[x][y]) {
+        return -1;
+    }
+    int before = revealedTiles;
+    if (getMineCount(x, y) == 0) {
+        revealEmptyTiles(x, y);
+    }
+    else {
+        states[x][y] = TileState::Revealed;
+        revealedTiles++;
+    }
+    return revealedTiles - before;
+}
+
+// Function to compare simulation throughput of the core runSimulations picks (a FixedBoard
+// for these sizes), DynamicBoard and the old Board path, for the standard sizes and the
+// shipped config.cfg size
+int runSimulationBenchmark(int games) {
+    const ConfigValues sizes[] = { { 9, 9, 10 }, { 16, 16, 40 }, { 30, 16, 99 }, { 25, 16, 50 } };
+    const unsigned seed = 12345;
+    bool allMatch = true;
+
+    cout << "board\tgames\tcore games/s\tdynamic games/s\told games/s\tcore vs dynamic\tdynamic vs old\tsame result" << endl;
+    for (const ConfigValues& config : sizes) {
+        auto start = chrono::steady_clock::now();
+        SimulationResult coreResult = runSimulations(config, games, seed);
+        auto coreDone = chrono::steady_clock::now();
+
+        DynamicBoard dynamicBoard(config.columns, config.rows);
+        SimulationResult dynamicResult = simulateGames(dynamicBoard, config.mines, games, seed);
+        auto dynamicDone = chrono::steady_clock::now();
+
+        LegacyBoard legacyBoard(config.columns, config.rows);
+        SimulationResult legacyResult = simulateGames(legacyBoard, config.mines, games, seed);
+        auto legacyDone = chrono::steady_clock::now();
+
+        double coreTime = chrono::duration<double>(coreDone - start).count();
+        double dynamicTime = chrono::duration<double>(dynamicDone - coreDone).count();
+        double legacyTime = chrono::duration<double>(legacyDone - dynamicDone).count();
+        bool match = coreResult.wins == dynamicResult.wins && coreResult.revealedTiles == dynamicResult.revealedTiles &&
+            coreResult.wins == legacyResult.wins && coreResult.revealedTiles == legacyResult.revealedTiles;
+        allMatch = allMatch && match;
+
+        cout << config.columns << "x" << config.rows << "\t" << games << "\t" << games / coreTime << "\t"
+            << games / dynamicTime << "\t" << games / legacyTime << "\t" << dynamicTime / coreTime << "\t"
+            << legacyTime / dynamicTime << "\t" << (match ? "yes" : "NO") << endl;
+    }
+
+    return allMatch ? 0 : 1;
 }
 
-int main() {
+// Function to time saving and restoring a game on a large board. The restored board must
+// draw the same frame and save to the same bytes.
+int runSnapshotBenchmark(int columns, int rows, int mines) {
+    const string firstFile = "boards/bench1.snap";
+    const string secondFile = "boards/bench2.snap";
+    const ConfigValues config = { columns, rows, mines };
+    const int windowWidth = columns * 32;
+    const int windowHeight = rows * 32 + 100;
+
+    // A game in progress: the opening plus a flag on every 97th tile
+    Board original(config, windowWidth, windowHeight);
+    original.reset();
+    for (long long tile = 0; tile < static_cast<long long>(columns) * rows; tile += 97) {
+        original.handleRightClick(sf::Vector2i(static_cast<int>(tile % columns) * 32, static_cast<int>(tile / columns) * 32));
+    }
+
+    Board restored(config, windowWidth, windowHeight);
+
+    auto start = chrono::steady_clock::now();
+    bool saved = original.saveSnapshot(firstFile);
+    auto savedTime = chrono::steady_clock::now();
+    bool loaded = saved && restored.loadSnapshot(firstFile);
+    auto loadedTime = chrono::steady_clock::now();
+
+    RenderFrame originalFrame;
+    RenderFrame restoredFrame;
+    original.captureFrame(originalFrame);
+    restored.captureFrame(restoredFrame);
+    bool sameFrame = originalFrame.tiles == restoredFrame.tiles && originalFrame.remainingMines == restoredFrame.remainingMines;
+
+    bool sameFile = false;
+    if (loaded && restored.saveSnapshot(secondFile)) {
+        ifstream first(firstFile, ios::binary);
+        ifstream second(secondFile, ios::binary);
+        sameFile = string(istreambuf_iterator<char>(first), istreambuf_iterator<char>()) ==
+            string(istreambuf_iterator<char>(second), istreambuf_iterator<char>());
+    }
+    remove(firstFile.c_str());
+    remove(secondFile.c_str());
+
+    cout << "Snapshot of " << columns << "x" << rows << " with " << mines << " mines" << endl;
+    cout << "save ms\tload ms\tsame frame\tsame file" << endl;
+    cout << chrono::duration<double, milli>(savedTime - start).count() << "\t"
+        << chrono::duration<double, milli>(loadedTime - savedTime).count() << "\t"
+        << (sameFrame ? "yes" : "NO") << "\t" << (sameFile ? "yes" : "NO") << endl;
+
+    return loaded && sameFrame && sameFile ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+    // Benchmark mode: project3 --bench-generation [columns rows mines]
+    if (argc > 1 && string(argv[1]) == "--bench-generation") {
+        int columns = argc > 4 ? atoi(argv[2]) : 16384;
+        int rows = argc > 4 ? atoi(argv[3]) : 16384;
+        int mines = argc > 4 ? atoi(argv[4]) : columns / 8 * rows;
+        return runGenerationBenchmark(columns, rows, mines);
+    }
+
+    // Benchmark mode: project3 --bench-snapshot [columns rows mines]
+    if (argc > 1 && string(argv[1]) == "--bench-snapshot") {
+        int columns = argc > 4 ? atoi(argv[2]) : 4096;
+        int rows = argc > 4 ? atoi(argv[3]) : 4096;
+        int mines = argc > 4 ? atoi(argv[4]) : columns / 8 * rows;
+        return runSnapshotBenchmark(columns, rows, mines);
+    }
+
+    // Benchmark mode: project3 --bench-simulation [games]
+    if (argc > 1 && string(argv[1]) == "--bench-simulation") {
+        return runSimulationBenchmark(argc > 2 ? atoi(argv[2]) : 200000);
+    }
+
     //configuration object
     ConfigValues config;
 
@@ -717,77 +2607,122 @@ int main() {
     int windowWidth = config.columns * 32;
     int windowHeight = config.rows * 32 + 100;
 
+    // project3 --single-threaded draws on the input thread like before
+    bool singleThreaded = argc > 1 && string(argv[1]) == "--single-threaded";
+
     sf::RenderWindow window(sf::VideoMode(windowWidth, windowHeight), "Minesweeper");
 
     Board minesweeper(config, windowWidth, windowHeight);  
 
-    // Load digit texture
-    sf::Texture digitTexture;
-    if (!digitTexture.loadFromFile("images/digits.png")) {
-        cerr << "Failed to load digit texture." << endl;
-        return 1;
+    // Pick up the game that was open when the window was last closed, or start a new one
+    const string snapshotFile = "boards/savegame.snap";
+    if (!minesweeper.loadSnapshot(snapshotFile)) {
+        minesweeper.reset();
     }
 
-    // Set digit width and height based on the digit texture
-    int digitWidth = 21;
-    int digitHeight = 32; 
+    // Left and right clicks are timestamped when they are taken off the event queue
+    LatencyStats latency;
 
-    sf::Sprite digitSprite;
-    digitSprite.setTexture(digitTexture);
+    if (singleThreaded) {
+        // Load digit texture
+        sf::Texture digitTexture;
+        if (!digitTexture.loadFromFile("images/digits.png")) {
+            cerr << "Failed to load digit texture." << endl;
+            return 1;
+        }
 
-    minesweeper.reset();  
+        sf::Sprite digitSprite;
+        digitSprite.setTexture(digitTexture);
 
-    // Run the program as long as the window is open
-    while (window.isOpen()) {
-        sf::Event event;
-        while (window.pollEvent(event)) {
-            if (event.type == sf::Event::Closed) {
-                window.close();
-            }
-            else if (event.type == sf::Event::MouseButtonPressed) {
-                if (event.mouseButton.button == sf::Mouse::Left) {
-                    minesweeper.handleLeftClick(static_cast<sf::Vector2i>(sf::Mouse::getPosition(window)));
+        vector<chrono::steady_clock::time_point> inputTimes;
+
+        // Run the program as long as the window is open
+        while (window.isOpen()) {
+            sf::Event event;
+            while (window.pollEvent(event)) {
+                if (event.type == sf::Event::Closed) {
+                    saveGameOnClose(minesweeper, snapshotFile);
+                    window.close();
                 }
-                else if (event.mouseButton.button == sf::Mouse::Right) {
-                    minesweeper.handleRightClick(static_cast<sf::Vector2i>(sf::Mouse::getPosition(window)));
+                else if (isBoardClick(event)) {
+                    inputTimes.push_back(chrono::steady_clock::now());
+                    handleMouseClick(minesweeper, event);
                 }
             }
-        }
 
-        // Clear the window with a white background
-        window.clear(sf::Color::White);
+            // Clear the window with a white background
+            window.clear(sf::Color::White);
 
-        // Draw the board and options space
-        minesweeper.draw(window);
+            // Draw the board and options space
+            minesweeper.draw(window);
 
-        // Draw the remaining mines count
-        string minesString = to_string(minesweeper.getRemainingMines());
-        int numDigits = minesString.size();
-        int totalWidth = digitWidth * numDigits;
+            // Draw the remaining mines count
+            drawMineCounter(window, digitSprite, minesweeper.getRemainingMines(), windowHeight);
 
-        // Center the counter between board and bottom of the window
-        int offsetX = 10; 
-        int offsetY = static_cast<int>((windowHeight - digitHeight * 2));
+            // Display the contents of the window
+            window.display();
 
-        // Draw the negative sign if the number is negative
-        if (minesweeper.getRemainingMines() < 0) {
-            digitSprite.setTextureRect(sf::IntRect(10 * digitWidth, 0, digitWidth, digitHeight));
-            digitSprite.setPosition(static_cast<float>(offsetX), static_cast<float>(offsetY));
-            window.draw(digitSprite);
-            offsetX += digitWidth;
+            chrono::steady_clock::time_point presented = chrono::steady_clock::now();
+            for (chrono::steady_clock::time_point input : inputTimes) {
+                latency.record(input, presented);
+            }
+            inputTimes.clear();
         }
 
-        for (size_t i = 0; i < numDigits; ++i) {
-            int digitValue = minesString[i] - '0';
-            digitSprite.setTextureRect(sf::IntRect(digitValue * digitWidth, 0, digitWidth, digitHeight));
+        latency.report();
+        return 0;
+    }
+
+    // Input and game logic stay on this thread, drawing happens on the render thread.
+    // The back frame catches up on the tiles that changed after every event batch.
+    TripleBuffer<RenderFrame> frames;
+    minesweeper.captureFrame(frames.back());
+    frames.publish();
 
-            digitSprite.setPosition(static_cast<float>(offsetX + i * digitWidth), static_cast<float>(offsetY));
-            window.draw(digitSprite);
+    window.setFramerateLimit(60);
+    window.setActive(false);
+    atomic<bool> rendering(true);
+    thread renderThread(renderLoop, ref(window), ref(frames), cref(rendering), ref(latency), windowWidth, windowHeight);
+
+    // Set when the last published frame was replaced before the render thread saw it
+    bool frameDropped = false;
+
+    while (window.isOpen()) {
+        sf::Event event;
+        if (!window.waitEvent(event)) {
+            continue;
         }
 
-        // Display the contents of the window
-        window.display();
+        bool changed = false;
+        bool closed = false;
+        do {
+            if (event.type == sf::Event::Closed) {
+                closed = true;
+            }
+            else if (isBoardClick(event)) {
+                // A dropped frame's clicks carry over to the next frame
+                if (!changed && !frameDropped) {
+                    frames.back().inputTimes.clear();
+                }
+                frames.back().inputTimes.push_back(chrono::steady_clock::now());
+                handleMouseClick(minesweeper, event);
+                changed = true;
+            }
+        } while (!closed && window.pollEvent(event));
+
+        if (closed) {
+            rendering = false;
+            renderThread.join();
+            saveGameOnClose(minesweeper, snapshotFile);
+            window.close();
+        }
+        else if (changed) {
+            minesweeper.captureFrame(frames.back());
+            frameDropped = frames.publish();
+        }
     }
 
+    latency.report();
+
     return 0;
 }
\ No newline at end of file